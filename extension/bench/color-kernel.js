@@ -0,0 +1,202 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Per-call cost of the color-utils kernel against the original port kept in
+ * ./reference: ns/op, bytes allocated per op (sampled heapUsed deltas) and
+ * young-generation collections per million ops. Every output is also checked
+ * against the reference first.
+ *
+ * usage: npm run bench:kernel
+ */
+
+import { PerformanceObserver, constants } from "node:perf_hooks";
+
+import * as current from "../src/theme-creator/color-utils";
+import * as reference from "./reference/color-utils";
+import { getAutogeneratedThemeColors } from "../src/theme-creator/autogenerated-theme-util";
+import { getAutogeneratedThemeColors as referenceThemeColors } from "./reference/autogenerated-theme-util";
+
+const OPS = 2_000_000;
+const SAMPLE_EVERY = 1024;
+
+// deterministic opaque colors covering the whole cube
+const COLORS = new Uint32Array(4096);
+for (let i = 0, x = 0x2545f491; i < COLORS.length; i++) {
+  x = (Math.imul(x, 1664525) + 1013904223) >>> 0;
+  COLORS[i] = (0xff000000 | (x >>> 8)) >>> 0;
+}
+const MASK = COLORS.length - 1;
+const HSLS = Array.from(COLORS, (c) => reference.argbToHSL(c));
+
+/** @type {import("../src/theme-creator/color-utils").HSL} */
+const scratchHsl = { h: 0, s: 0, l: 0 };
+
+/**
+ * @typedef {Object} Case
+ * @property {string} name
+ * @property {number} ops
+ * @property {(i: number) => unknown} before
+ * @property {(i: number) => unknown} after
+ */
+
+/** @type {Case[]} */
+const CASES = [
+  {
+    name: "argbToHSL",
+    ops: OPS,
+    before: (i) => reference.argbToHSL(COLORS[i & MASK]),
+    after: (i) => current.argbToHSL(COLORS[i & MASK], scratchHsl),
+  },
+  {
+    name: "hSLToArgb",
+    ops: OPS,
+    before: (i) => reference.hSLToArgb(HSLS[i & MASK], 0xff),
+    after: (i) => current.hSLToArgb(HSLS[i & MASK], 0xff),
+  },
+  {
+    name: "getRelativeLuminance",
+    ops: OPS,
+    before: (i) => reference.getRelativeLuminance(COLORS[i & MASK]),
+    after: (i) => current.getRelativeLuminance(COLORS[i & MASK]),
+  },
+  {
+    name: "blendForMinContrast",
+    ops: OPS / 4,
+    before: (i) =>
+      reference.blendForMinContrast(
+        COLORS[i & MASK],
+        COLORS[(i + 1) & MASK],
+        null,
+        7.0,
+      ).color,
+    after: (i) =>
+      current.blendForMinContrast(
+        COLORS[i & MASK],
+        COLORS[(i + 1) & MASK],
+        null,
+        7.0,
+      ).color,
+  },
+  {
+    name: "getAutogeneratedThemeColors",
+    ops: OPS / 40,
+    before: (i) => referenceThemeColors(COLORS[i & MASK]).activeTabColor,
+    after: (i) => getAutogeneratedThemeColors(COLORS[i & MASK]).activeTabColor,
+  },
+];
+
+/**
+ * @param {unknown} a
+ * @param {unknown} b
+ */
+function same(a, b) {
+  if (typeof a === "number" && typeof b === "number") {
+    return a >>> 0 === b >>> 0;
+  }
+  return JSON.stringify(a) === JSON.stringify(b);
+}
+
+let scavenges = 0;
+new PerformanceObserver((list) => {
+  for (const entry of list.getEntries()) {
+    // @ts-ignore detail is set for gc entries
+    if (entry.detail?.kind === constants.NODE_PERFORMANCE_GC_MINOR) scavenges++;
+  }
+}).observe({ entryTypes: ["gc"] });
+
+/** Lets queued gc entries reach the observer. */
+const flushGc = () => new Promise((resolve) => setImmediate(resolve));
+
+/**
+ * Loops are built per function so every call site stays monomorphic and the
+ * kernel can be inlined as it would be in the extension.
+ *
+ * @param {(i: number) => unknown} fn
+ */
+function loops(fn) {
+  return {
+    /** @param {number} ops */
+    time(ops) {
+      const start = process.hrtime.bigint();
+      for (let i = 0; i < ops; i++) fn(i);
+      return Number(process.hrtime.bigint() - start) / ops;
+    },
+    // heapUsed only grows between collections, so windows that shrink had a
+    // scavenge in them and are dropped
+    /** @param {number} ops */
+    allocated(ops) {
+      let grown = 0;
+      let counted = 0;
+      let last = process.memoryUsage().heapUsed;
+      for (let i = 0; i < ops; i++) {
+        fn(i);
+        if ((i + 1) % SAMPLE_EVERY === 0) {
+          const now = process.memoryUsage().heapUsed;
+          if (now >= last) {
+            grown += now - last;
+            counted += SAMPLE_EVERY;
+          }
+          last = now;
+        }
+      }
+      return counted ? grown / counted : 0;
+    },
+  };
+}
+
+/**
+ * @param {(i: number) => unknown} fn
+ * @param {number} ops
+ * @returns {Promise<{ ns: number, bytes: number, gcs: number }>}
+ */
+async function measure(fn, ops) {
+  const run = loops(fn);
+  run.time(ops / 10);
+  await flushGc();
+
+  const ns = run.time(ops);
+  await flushGc();
+
+  scavenges = 0;
+  const bytes = run.allocated(ops);
+  await flushGc();
+
+  return { ns, bytes, gcs: (scavenges * 1e6) / ops };
+}
+
+let mismatched = 0;
+for (const { name, before, after } of CASES) {
+  for (let i = 0; i < COLORS.length; i++) {
+    if (!same(before(i), after(i))) {
+      mismatched++;
+      console.log(`${name}: output differs for #${COLORS[i].toString(16)}`);
+      break;
+    }
+  }
+}
+if (mismatched) process.exit(1);
+
+console.log(
+  `${"".padEnd(28)} ${"ns/op".padStart(17)} ${"bytes/op".padStart(17)} ${"scavenges/1M".padStart(17)}`,
+);
+// the sampling itself allocates; subtract what an empty loop reports
+const baseline = await measure((i) => i, OPS);
+for (const { name, ops, before, after } of CASES) {
+  const b = await measure(before, ops);
+  const a = await measure(after, ops);
+  b.bytes = Math.max(0, b.bytes - baseline.bytes);
+  a.bytes = Math.max(0, a.bytes - baseline.bytes);
+  /** @param {number} x @param {number} y @param {number} digits */
+  const pair = (x, y, digits) =>
+    `${x.toFixed(digits).padStart(8)}→${y.toFixed(digits).padEnd(8)}`;
+  console.log(
+    `${name.padEnd(28)} ${pair(b.ns, a.ns, 1)} ${pair(b.bytes, a.bytes, 1)} ${pair(b.gcs, a.gcs, 1)}`,
+  );
+}
+
+process.exit(0);
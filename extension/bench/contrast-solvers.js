@@ -0,0 +1,80 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Conformance check and benchmark for the contrast solvers used by
+ * getAutogeneratedThemeColors, against the original bisection port kept in
+ * ./reference.
+ *
+ * usage: npm run bench:contrast -- [stride]
+ *   stride 1 (the default) checks all 2^24 opaque seeds.
+ */
+
+import { getAutogeneratedThemeColors } from "../src/theme-creator/autogenerated-theme-util";
+import { getAutogeneratedThemeColors as referenceThemeColors } from "./reference/autogenerated-theme-util";
+
+const SEEDS = 1 << 24;
+const stride = Number(process.argv[2] ?? 1);
+if (!Number.isInteger(stride) || stride < 1) {
+  console.error("usage: contrast-solvers [stride >= 1]");
+  process.exit(2);
+}
+
+/** @param {number} c */
+const hex = (c) => (c & 0xffffff).toString(16).padStart(6, "0");
+
+/** @type {(keyof ReturnType<typeof getAutogeneratedThemeColors>)[]} */
+const KEYS = [
+  "frameColor",
+  "frameTextColor",
+  "activeTabColor",
+  "activeTabTextColor",
+];
+
+let checked = 0;
+let mismatched = 0;
+for (let seed = 0; seed < SEEDS; seed += stride) {
+  const argb = (0xff000000 | seed) >>> 0;
+  const actual = getAutogeneratedThemeColors(argb);
+  const expected = referenceThemeColors(argb);
+  checked++;
+  for (const key of KEYS) {
+    if ((actual[key] & 0xffffff) !== (expected[key] & 0xffffff)) {
+      mismatched++;
+      if (mismatched <= 20) {
+        console.log(
+          `#${hex(seed)} ${key}: reference #${hex(expected[key])} solver #${hex(actual[key])}`,
+        );
+      }
+      break;
+    }
+  }
+}
+console.log(`conformance: ${checked - mismatched}/${checked} seeds match`);
+
+/**
+ * @param {string} name
+ * @param {(argb: number) => unknown} fn
+ * @returns {number} ns per theme
+ */
+function bench(name, fn) {
+  const seeds = 200_000;
+  const step = Math.floor(SEEDS / seeds);
+  for (let i = 0; i < seeds; i += 10) fn((0xff000000 | (i * step)) >>> 0);
+
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < seeds; i++) fn((0xff000000 | (i * step)) >>> 0);
+  const ns = Number(process.hrtime.bigint() - start) / seeds;
+  console.log(`${name.padEnd(10)} ${ns.toFixed(0).padStart(7)} ns/theme`);
+  return ns;
+}
+
+const before = bench("bisection", referenceThemeColors);
+const after = bench("solver", getAutogeneratedThemeColors);
+console.log(`speedup    ${(before / after).toFixed(2)}x`);
+
+process.exit(mismatched === 0 ? 0 : 1);
@@ -0,0 +1,162 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Per-theme cost of the slim Material scheme against themeFromSourceColor.
+ * Before timing, every sample seed's roles, greys and yellows included, are
+ * checked to come out identical on both paths, and createFirefoxTheme's theme
+ * to equal the baseline one kept in ./reference. Run it against the real
+ * library: a stub only checks the plumbing.
+ *
+ * createFirefoxTheme keeps using themeFromSourceColor until this passes
+ * against @material/material-color-utilities.
+ *
+ * Cold times use a new seed per call, the switch-to-a-new-theme case; warm
+ * times cycle through a few seeds, so the slim path's palettes stay cached.
+ *
+ * usage: npm run bench:scheme
+ */
+
+import { themeFromSourceColor } from "@material/material-color-utilities";
+
+import { createFirefoxTheme } from "../src/theme-creator";
+import { isDark } from "../src/theme-creator/color-utils";
+import { materialRoles } from "../src/theme-creator/material-scheme";
+import { createFirefoxTheme as referenceTheme } from "./reference/create-firefox-theme";
+
+// deterministic opaque colors covering the whole cube
+const COLORS = new Uint32Array(4096);
+for (let i = 0, x = 0x2545f491; i < COLORS.length; i++) {
+  x = (Math.imul(x, 1664525) + 1013904223) >>> 0;
+  COLORS[i] = (0xff000000 | (x >>> 8)) >>> 0;
+}
+
+// random seeds rarely land on these: greys, whose hue is noise and whose
+// primary chroma is the floor, and yellows, whose light background is the
+// averaged tone 99
+const EDGE_COLORS = [
+  ...Array.from(
+    { length: 18 },
+    (_, i) => (0xff000000 | (i * 15 * 0x010101)) >>> 0,
+  ),
+  0xff121214,
+  0xff1e1c1c,
+  0xff282a28,
+  0xff808084,
+  0xffe6e4e4,
+  0xffffff00,
+  0xffffd700,
+  0xfff0e68c,
+  0xffe5c07b,
+  0xffd7af00,
+  0xff808000,
+];
+
+// warm runs cycle through this many seeds, under the palette cache's 64/4
+const WARM_SEEDS = 8;
+
+/** @type {(argb: number) => [number, number, number]} */
+const rgb = (argb) => [(argb >>> 16) & 0xff, (argb >>> 8) & 0xff, argb & 0xff];
+
+let mismatched = 0;
+for (const argb of [...EDGE_COLORS, ...COLORS]) {
+  let same = true;
+  const dark = isDark(argb);
+  const full = themeFromSourceColor(argb).schemes[dark ? "dark" : "light"];
+  const slim = materialRoles(argb, dark);
+  for (const [role, value] of Object.entries(slim)) {
+    const expected = full[/** @type {keyof typeof full} */ (role)];
+    if (value >>> 0 !== /** @type {number} */ (expected) >>> 0) {
+      same = false;
+      console.log(`#${argb.toString(16)} ${role}: ${expected} != ${value}`);
+    }
+  }
+  const [r, g, b] = rgb(argb);
+  const before = JSON.stringify(referenceTheme(r, g, b));
+  const after = JSON.stringify(createFirefoxTheme(r, g, b));
+  if (before !== after) {
+    same = false;
+    console.log(`#${argb.toString(16)} theme differs:`);
+    console.log(`  ${before}\n  ${after}`);
+  }
+  if (!same) mismatched++;
+}
+const checked = EDGE_COLORS.length + COLORS.length;
+console.log(`${checked - mismatched}/${checked} seeds identical`);
+if (mismatched) process.exit(1);
+
+/**
+ * @param {(i: number) => unknown} fn
+ * @param {number} ops
+ * @returns {number}  Microseconds per call.
+ */
+function time(fn, ops) {
+  for (let i = 0; i < ops / 10; i++) fn(i);
+  const start = process.hrtime.bigint();
+  for (let i = 0; i < ops; i++) fn(i);
+  return Number(process.hrtime.bigint() - start) / ops / 1000;
+}
+
+/**
+ * What createFirefoxTheme builds to read the same roles.
+ *
+ * @param {number} argb
+ */
+function fullScheme(argb) {
+  const { schemes } = themeFromSourceColor(argb);
+  return isDark(argb) ? schemes.dark : schemes.light;
+}
+
+// cold calls must not repeat a seed, so they get fresh ones
+let fresh = 0x13579b;
+const nextSeed = () => {
+  fresh = (Math.imul(fresh, 1664525) + 1013904223) >>> 0;
+  return (0xff000000 | (fresh >>> 8)) >>> 0;
+};
+
+/**
+ * Name, reference path, slim path, calls.
+ * @type {[string, (i: number) => unknown, (i: number) => unknown, number][]}
+ */
+const CASES = [
+  [
+    "scheme, cold",
+    () => {
+      const argb = nextSeed();
+      return fullScheme(argb);
+    },
+    () => {
+      const argb = nextSeed();
+      return materialRoles(argb, isDark(argb));
+    },
+    2000,
+  ],
+  [
+    "scheme, warm",
+    (i) => {
+      const argb = COLORS[i % WARM_SEEDS];
+      return fullScheme(argb);
+    },
+    (i) => {
+      const argb = COLORS[i % WARM_SEEDS];
+      return materialRoles(argb, isDark(argb));
+    },
+    2000,
+  ],
+];
+
+console.log(`${"".padEnd(26)} ${"µs/op".padStart(19)}`);
+for (const [name, before, after, ops] of CASES) {
+  const b = time(before, ops);
+  const a = time(after, ops);
+  console.log(
+    `${name.padEnd(26)} ${b.toFixed(1).padStart(8)}→` +
+      `${a.toFixed(1).padEnd(8)} ${(b / a).toFixed(2)}x`,
+  );
+}
+
+process.exit(0);
@@ -0,0 +1,196 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Evaluates createFirefoxTheme over an RGB grid and writes the results as a
+ * theme atlas, see src/ThemeAtlas.js for the format. Fails if the atlas is
+ * larger than ATLAS_BUDGET_BYTES.
+ *
+ * usage: npm run build:atlas -- [steps]
+ *        node build/build-theme-atlas.js <out file> [steps]
+ */
+
+import { writeFileSync } from "node:fs";
+import {
+  ATLAS_MAGIC,
+  ATLAS_SCHEMES,
+  ThemeAtlas,
+} from "../src/ThemeAtlas";
+import {
+  createFirefoxTheme,
+  THEME_ALGORITHM_VERSION,
+} from "../src/theme-creator";
+
+// the atlas ships in every XPI, and is read whenever the extension has to
+// build a theme itself
+const ATLAS_BUDGET_BYTES = 640 * 1024;
+
+const out = process.argv[2];
+const steps = Number(process.argv[3] ?? 32);
+if (!out || !Number.isInteger(steps) || steps < 2 || steps > 255) {
+  console.error("usage: build-theme-atlas <out file> [steps 2..255]");
+  process.exit(2);
+}
+
+/**
+ * Growable little-endian byte buffer.
+ */
+class Writer {
+  /** @type {number[]} */
+  bytes = [];
+
+  /** @param {number} v */
+  u8(v) {
+    this.bytes.push(v & 0xff);
+  }
+
+  /** @param {number} v */
+  u32(v) {
+    for (let i = 0; i < 4; i++) this.u8(Math.floor(v / 2 ** (8 * i)));
+  }
+
+  /** @param {number} v  Non-negative. */
+  varint(v) {
+    while (v >= 0x80) {
+      this.u8((v % 0x80) | 0x80);
+      v = Math.floor(v / 0x80);
+    }
+    this.u8(v);
+  }
+
+  /** @param {Writer} w */
+  block(w) {
+    this.u32(w.bytes.length);
+    for (const b of w.bytes) this.bytes.push(b);
+  }
+}
+
+/**
+ * Encodes per-cell indices as an index stream.
+ *
+ * @param {number[]} indices
+ * @returns {Writer}
+ */
+function encodeIndices(indices) {
+  const w = new Writer();
+  let prev = 0;
+  let cell = 0;
+  while (cell < indices.length) {
+    const d = indices[cell] - prev;
+    w.varint(d < 0 ? -2 * d - 1 : 2 * d);
+    prev = indices[cell++];
+    if (d === 0) {
+      const start = cell;
+      while (cell < indices.length && indices[cell] === prev) cell++;
+      w.varint(cell - start);
+    }
+  }
+  return w;
+}
+
+/** @type {number[]} */
+const axis = [];
+for (let i = 0; i < steps; i++) {
+  axis.push(Math.round((i * 255) / (steps - 1)));
+}
+
+/** @type {import("../src/ThemeAtlas").FirefoxTheme[]} */
+const themes = [];
+const started = performance.now();
+for (const r of axis) {
+  for (const g of axis) {
+    for (const b of axis) {
+      themes.push(createFirefoxTheme(r, g, b));
+    }
+  }
+}
+const buildMs = performance.now() - started;
+
+const names = Object.keys(themes[0].colors);
+/** @type {(name: string) => string[]} */
+const column = (name) =>
+  themes.map((t) => t.colors[/** @type {keyof typeof t.colors} */ (name)]);
+const columns = names.map(column);
+
+const w = new Writer();
+for (const c of ATLAS_MAGIC) w.u8(c.charCodeAt(0));
+w.u32(THEME_ALGORITHM_VERSION);
+w.u8(steps);
+w.u8(names.length);
+
+// slots that hold the same color as an earlier slot in every cell are
+// stored once
+/** @type {number[]} */
+const sources = names.map((_, i) => {
+  const same = columns.findIndex(
+    (other, j) => j < i && other.every((v, k) => v === columns[i][k]),
+  );
+  return same === -1 ? i : same;
+});
+names.forEach((name, i) => {
+  w.u8(name.length);
+  for (const c of name) w.u8(c.charCodeAt(0));
+  w.u8(sources[i]);
+});
+
+for (let i = 0; i < names.length; i++) {
+  if (sources[i] !== i) continue;
+  // palette in order of first use, so a new color is mostly one index past
+  // the previous cell's
+  /** @type {Map<string, number>} */
+  const palette = new Map();
+  const indices = columns[i].map((hex) => {
+    let p = palette.get(hex);
+    if (p === undefined) {
+      p = palette.size;
+      palette.set(hex, p);
+    }
+    return p;
+  });
+  w.u32(palette.size);
+  for (const hex of palette.keys()) {
+    const packed = parseInt(hex.slice(1), 16);
+    w.u8(packed >> 16);
+    w.u8(packed >> 8);
+    w.u8(packed);
+  }
+  w.block(encodeIndices(indices));
+}
+w.block(
+  encodeIndices(
+    themes.map((t) => ATLAS_SCHEMES.indexOf(t.properties.color_scheme)),
+  ),
+);
+
+const bytes = Uint8Array.from(w.bytes);
+
+// what the extension will see must be what was built
+const atlas = ThemeAtlas.decode(bytes.buffer, THEME_ALGORITHM_VERSION);
+let i = 0;
+for (const r of axis) {
+  for (const g of axis) {
+    for (const b of axis) {
+      const got = atlas.lookup(r, g, b);
+      if (JSON.stringify(got) !== JSON.stringify(themes[i++])) {
+        console.error(`atlas round trip differs at [${r},${g},${b}]`);
+        process.exit(1);
+      }
+    }
+  }
+}
+
+console.log(
+  `${themes.length} themes in ${buildMs.toFixed(0)} ms, ` +
+    `${names.length - sources.filter((s, i) => s !== i).length}/` +
+    `${names.length} slots stored, ${bytes.length} bytes ` +
+    `(budget ${ATLAS_BUDGET_BYTES})`,
+);
+if (bytes.length > ATLAS_BUDGET_BYTES) {
+  console.error("atlas is over budget; lower the steps");
+  process.exit(1);
+}
+writeFileSync(out, bytes);
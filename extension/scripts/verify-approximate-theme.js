@@ -0,0 +1,110 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Measures how far createApproximateTheme lands from createFirefoxTheme, per
+ * color slot in Oklab ΔE, over random seeds and the greys in GREY_SEEDS.
+ * Fails if any slot exceeds the limit or any color scheme differs.
+ *
+ * Greys are checked apart from random seeds, which rarely land on one: their
+ * HSL hue says nothing about the hue of their Material palettes.
+ *
+ * usage: npm run verify:approximate -- [samples] [max ΔE]
+ */
+
+import { argbFromHex } from "@material/material-color-utilities";
+import {
+  createApproximateTheme,
+  createFirefoxTheme,
+} from "../src/theme-creator";
+import { deltaEOklab } from "../src/theme-creator/color-utils";
+
+const samples = Number(process.argv[2] ?? 2000);
+const limit = Number(process.argv[3] ?? 0.25);
+if (!Number.isInteger(samples) || samples < 1 || !(limit >= 0)) {
+  console.error("usage: verify-approximate-theme [samples] [max ΔE]");
+  process.exit(2);
+}
+
+/**
+ * Pure greys across the range, and a few seeds barely off grey.
+ *
+ * @type {[number, number, number][]}
+ */
+const GREY_SEEDS = [
+  ...Array.from({ length: 18 }, (_, i) => {
+    const v = i * 15;
+    return /** @type {[number, number, number]} */ ([v, v, v]);
+  }),
+  [18, 18, 20],
+  [30, 28, 28],
+  [40, 42, 40],
+  [128, 128, 132],
+  [230, 228, 228],
+];
+
+// fixed seed so runs compare
+let state = 0x2545f491;
+function randomByte() {
+  state ^= state << 13;
+  state ^= state >>> 17;
+  state ^= state << 5;
+  return (state >>> 0) & 0xff;
+}
+
+/**
+ * ΔE per slot, and the worst seed, for one set of seeds.
+ *
+ * @param {string} label
+ * @param {[number, number, number][]} seeds
+ * @returns {boolean}  True if every slot stayed within the limit.
+ */
+function measure(label, seeds) {
+  /** @type {Record<string, number[]>} */
+  const errors = {};
+  let schemeFlips = 0;
+  let worst = { error: 0, slot: "", seed: [0, 0, 0] };
+
+  for (const seed of seeds) {
+    const exact = createFirefoxTheme(...seed);
+    const approx = createApproximateTheme(...seed);
+    if (approx.properties.color_scheme !== exact.properties.color_scheme) {
+      schemeFlips++;
+    }
+    for (const [slot, hex] of Object.entries(exact.colors)) {
+      const other =
+        approx.colors[/** @type {keyof typeof approx.colors} */ (slot)];
+      const error = deltaEOklab(argbFromHex(hex), argbFromHex(other));
+      (errors[slot] ??= []).push(error);
+      if (error > worst.error) worst = { error, slot, seed };
+    }
+  }
+
+  console.log(`${label}: ${seeds.length} seeds, ${schemeFlips} scheme flips`);
+  for (const [slot, list] of Object.entries(errors)) {
+    list.sort((a, b) => a - b);
+    const at = (/** @type {number} */ p) =>
+      list[Math.min(list.length - 1, Math.floor(p * list.length))];
+    console.log(
+      `  ${slot.padEnd(28)} p50 ${at(0.5).toFixed(4)} ` +
+        `p95 ${at(0.95).toFixed(4)} max ${list[list.length - 1].toFixed(4)}`,
+    );
+  }
+  console.log(
+    `  worst ${worst.error.toFixed(4)}: ${worst.slot} at [${worst.seed}]`,
+  );
+  return worst.error <= limit && schemeFlips === 0;
+}
+
+/** @type {[number, number, number][]} */
+const random = [];
+for (let i = 0; i < samples; i++) {
+  random.push([randomByte(), randomByte(), randomByte()]);
+}
+
+const ok = [measure("random", random), measure("greys", GREY_SEEDS)];
+process.exit(ok.every(Boolean) ? 0 : 1);
@@ -0,0 +1,90 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Compares `omarchy-firefox-themehost --theme R,G,B` against the baseline
+ * createFirefoxTheme in bench/reference, which takes its roles from
+ * themeFromSourceColor, over a sampled RGB cube plus the seeds in
+ * EXTRA_SEEDS, and prints every slot that differs.
+ *
+ * usage: npm run verify:native -- <path to omarchy-firefox-themehost> [steps]
+ */
+
+import { execFileSync } from "node:child_process";
+import { createFirefoxTheme } from "../bench/reference/create-firefox-theme";
+
+const host = process.argv[2];
+const steps = Number(process.argv[3] ?? 9);
+if (!host || !Number.isInteger(steps) || steps < 2) {
+  console.error("usage: verify-native-theme <host binary> [steps >= 2]");
+  process.exit(2);
+}
+
+/**
+ * Seeds the cube can miss that take special paths in the library: greys,
+ * whose hue is arbitrary, and light seeds in the yellow hue band, whose
+ * tone 99 TonalPalette takes as the midpoint of tones 98 and 100.
+ *
+ * @type {[number, number, number][]}
+ */
+const EXTRA_SEEDS = [
+  [18, 18, 18],
+  [40, 40, 40],
+  [128, 128, 128],
+  [230, 230, 230],
+  [255, 255, 0],
+  [240, 220, 60],
+  [200, 200, 0],
+  [250, 240, 150],
+  [160, 170, 40],
+  [128, 160, 32],
+];
+
+/** @type {number[]} */
+const axis = [];
+for (let i = 0; i < steps; i++) {
+  axis.push(Math.round((i * 255) / (steps - 1)));
+}
+
+/** @type {[number, number, number][]} */
+const seedList = [...EXTRA_SEEDS];
+for (const r of axis) {
+  for (const g of axis) {
+    for (const b of axis) {
+      seedList.push([r, g, b]);
+    }
+  }
+}
+
+let mismatched = 0;
+for (const [r, g, b] of seedList) {
+  const expected = createFirefoxTheme(r, g, b);
+  const actual = JSON.parse(
+    execFileSync(host, ["--theme", `${r},${g},${b}`], { encoding: "utf8" }),
+  );
+
+  /** @type {string[]} */
+  const diffs = [];
+  for (const [key, value] of Object.entries(expected.colors)) {
+    if (actual.colors[key] !== value) {
+      diffs.push(`${key}: js ${value} native ${actual.colors[key]}`);
+    }
+  }
+  if (actual.properties.color_scheme !== expected.properties.color_scheme) {
+    diffs.push(
+      `color_scheme: js ${expected.properties.color_scheme} native ${actual.properties.color_scheme}`,
+    );
+  }
+
+  if (diffs.length > 0) {
+    mismatched++;
+    console.log(`[${r},${g},${b}]\n  ${diffs.join("\n  ")}`);
+  }
+}
+
+console.log(`${seedList.length - mismatched}/${seedList.length} seeds match`);
+process.exit(mismatched === 0 ? 0 : 1);
@@ -0,0 +1,82 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Measures how far atlas lookups land from createFirefoxTheme for random
+ * seeds: the largest Oklab ΔE over the color slots, and how often the color
+ * scheme differs. Fails if the ΔE exceeds the limit or any scheme differs.
+ *
+ * The largest errors are near-grey seeds, whose hue the grid cannot pin
+ * down. PKGBUILD runs this on the atlas it ships, with the default limit.
+ *
+ * usage: npm run verify:atlas -- [samples] [max ΔE]
+ *        node build/verify-theme-atlas.js <atlas file> [samples] [max ΔE]
+ */
+
+import { readFileSync } from "node:fs";
+import { ThemeAtlas } from "../src/ThemeAtlas";
+import {
+  createFirefoxTheme,
+  THEME_ALGORITHM_VERSION,
+  themeDistance,
+} from "../src/theme-creator";
+
+const file = process.argv[2];
+const samples = Number(process.argv[3] ?? 2000);
+const limit = Number(process.argv[4] ?? 0.25);
+if (!file || !Number.isInteger(samples) || samples < 1 || !(limit >= 0)) {
+  console.error("usage: verify-theme-atlas <atlas file> [samples] [max ΔE]");
+  process.exit(2);
+}
+
+const buf = readFileSync(file);
+const atlas = ThemeAtlas.decode(
+  buf.buffer.slice(buf.byteOffset, buf.byteOffset + buf.length),
+  THEME_ALGORITHM_VERSION,
+);
+
+// fixed seed so runs compare
+let state = 0x9e3779b9;
+function randomByte() {
+  state ^= state << 13;
+  state ^= state >>> 17;
+  state ^= state << 5;
+  return (state >>> 0) & 0xff;
+}
+
+/** @type {number[]} */
+const errors = [];
+let schemeFlips = 0;
+let worst = { error: 0, seed: [0, 0, 0] };
+
+for (let i = 0; i < samples; i++) {
+  const seed = [randomByte(), randomByte(), randomByte()];
+  const exact = createFirefoxTheme(seed[0], seed[1], seed[2]);
+  const approx = atlas.lookup(seed[0], seed[1], seed[2]);
+  if (approx.properties.color_scheme !== exact.properties.color_scheme) {
+    schemeFlips++;
+  }
+  // compare the colors alone; a scheme flip is counted above
+  const error = themeDistance(exact, {
+    colors: approx.colors,
+    properties: exact.properties,
+  });
+  errors.push(error);
+  if (error > worst.error) worst = { error, seed };
+}
+
+errors.sort((a, b) => a - b);
+const at = (/** @type {number} */ p) =>
+  errors[Math.min(errors.length - 1, Math.floor(p * errors.length))];
+const [r, g, b] = worst.seed;
+console.log(
+  `${samples} seeds: ΔE p50 ${at(0.5).toFixed(4)} ` +
+    `p99 ${at(0.99).toFixed(4)} max ${worst.error.toFixed(4)} ` +
+    `at [${worst.seed}] (grid seed [${atlas.gridSeed(r, g, b)}]), ` +
+    `${schemeFlips} color scheme flips`,
+);
+process.exit(worst.error <= limit && schemeFlips === 0 ? 0 : 1);
@@ -0,0 +1,148 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Work that applies one theme. The signal aborts once a newer task is
+ * scheduled, so the task can stop before paying for a restyle nobody will
+ * see.
+ *
+ * @typedef ApplyTask
+ * @type {function}
+ * @param {AbortSignal} signal
+ * @returns {Promise<void>}
+ */
+
+/**
+ * A task waiting for its turn.
+ *
+ * @typedef QueuedTask
+ * @type {object}
+ * @property {ApplyTask} task
+ * @property {(ran: boolean) => void} resolve
+ * @property {(err: unknown) => void} reject
+ */
+
+/**
+ * Counters of an ApplyScheduler.
+ * @typedef {Object} ApplySchedulerStats
+ * @property {number} started     Tasks that ran.
+ * @property {number} superseded  Tasks replaced before they could run.
+ */
+
+/**
+ * Runs theme applies one at a time, newest wins. While a task runs, later
+ * ones wait in a single slot, each replacing the last, so a burst of colors
+ * costs at most the apply in progress plus one for the final color. Task
+ * starts can also be spaced out to cap the restyle rate.
+ */
+export class ApplyScheduler {
+  /** @private @type {number} */
+  #minIntervalMs = 0;
+
+  /** @private @type {number} */
+  #lastStart = -Infinity;
+
+  /** @private @type {boolean} */
+  #running = false;
+
+  /** @private @type {QueuedTask|null} */
+  #next = null;
+
+  /**
+   * Aborted when the running task is no longer the newest.
+   * @private @type {AbortController|null}
+   */
+  #current = null;
+
+  /** @private @type {number} */
+  #started = 0;
+
+  /** @private @type {number} */
+  #superseded = 0;
+
+  /**
+   * @param {number} [maxRate]  Most task starts per second, 0 for no cap.
+   */
+  constructor(maxRate = 0) {
+    this.setMaxRate(maxRate);
+  }
+
+  /**
+   * Caps how often tasks start, e.g. to the display's refresh rate.
+   *
+   * @param {unknown} maxRate  Starts per second; 0 or less removes the cap.
+   * @returns {void}
+   * @throws If maxRate is not a finite number.
+   */
+  setMaxRate(maxRate) {
+    if (typeof maxRate !== "number" || !Number.isFinite(maxRate)) {
+      throw new Error(`apply rate '${maxRate}' is not a number`);
+    }
+    this.#minIntervalMs = maxRate > 0 ? 1000 / maxRate : 0;
+  }
+
+  /**
+   * Queues a task behind the one running, replacing any task still waiting.
+   *
+   * @param {ApplyTask} task
+   * @returns {Promise<boolean>}  True once the task ran, false if a newer
+   *   one replaced it first. Rejects with whatever the task threw.
+   */
+  schedule(task) {
+    return new Promise((resolve, reject) => {
+      if (this.#next) {
+        this.#superseded++;
+        this.#next.resolve(false);
+      }
+      this.#next = { task, resolve, reject };
+      this.#current?.abort();
+      if (!this.#running) void this.#drain();
+    });
+  }
+
+  /**
+   * @returns {ApplySchedulerStats}
+   */
+  stats() {
+    return { started: this.#started, superseded: this.#superseded };
+  }
+
+  /**
+   * Runs queued tasks until none is left.
+   *
+   * @private
+   * @returns {Promise<void>}
+   */
+  async #drain() {
+    this.#running = true;
+    try {
+      while (this.#next) {
+        const wait = this.#lastStart + this.#minIntervalMs - performance.now();
+        if (wait > 0) {
+          // a task scheduled during the wait replaces this.#next, so only
+          // the newest one runs once it is over
+          await new Promise((r) => setTimeout(r, wait));
+        }
+
+        const queued = /** @type {QueuedTask} */ (this.#next);
+        this.#next = null;
+        this.#current = new AbortController();
+        this.#lastStart = performance.now();
+        this.#started++;
+        try {
+          await queued.task(this.#current.signal);
+          queued.resolve(true);
+        } catch (e) {
+          queued.reject(e);
+        }
+      }
+    } finally {
+      this.#current = null;
+      this.#running = false;
+    }
+  }
+}
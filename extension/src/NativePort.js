@@ -14,6 +14,32 @@
  * @returns {void}
  */
 
+/**
+ * Requests the native host answers with a reply of the same `type`. The host
+ * answers repeats of a request it has not answered yet with a single reply.
+ * It also takes `get`, which resends its latest theme message; the extension
+ * never needs it, since the host sends that message on every connect.
+ *
+ * @typedef {"ping"|"stats"} ReplyRequestType
+ */
+
+/**
+ * Reply types the host sends for each {@link ReplyRequestType}.
+ *
+ * @type {Readonly<Record<ReplyRequestType, string>>}
+ */
+const REPLY_TYPES = Object.freeze({ ping: "pong", stats: "stats" });
+
+/**
+ * A request waiting for its reply.
+ *
+ * @typedef PendingRequest
+ * @type {object}
+ * @property {(reply: Record<string, unknown>) => void} resolve
+ * @property {(err: Error) => void} reject
+ * @property {number} timer
+ */
+
 /**
  * Manages a persistent `browser.runtime.connectNative` port,
  * handling disconnects and reconnection backoff automatically.
@@ -46,6 +72,14 @@ export class NativePort {
   /** @private @type {(m: unknown) => void}|null */
   #onMessageHandlerRef = null;
 
+  /**
+   * Requests waiting for a reply, oldest first, by reply type. All of a
+   * type wait on the request sent for the first of them.
+   *
+   * @private @type {Map<string, PendingRequest[]>}
+   */
+  #pending = new Map();
+
   /** @private @type {() => void}|null */
   #onDisconnectHandlerRef = null;
 
@@ -102,6 +136,7 @@ export class NativePort {
       this.#port = null;
       this.#onMessageHandlerRef = null;
       this.#onDisconnectHandlerRef = null;
+      this.#rejectPending();
     }
   }
 
@@ -118,8 +153,8 @@ export class NativePort {
   /**
    * Sends a message to the native host if connected.
    *
-   * Note: the native app in your deployment is one-way (native -> extension),
-   * but this method is kept for completeness and defensive use.
+   * The host reads framed requests of the form `{ type: string }`; anything
+   * else, such as the `{}` sent on connect, is ignored.
    *
    * @param {unknown} obj  Any JSON-serializable payload.
    * @returns {void}
@@ -133,6 +168,79 @@ export class NativePort {
     }
   }
 
+  /**
+   * Sends a request to the native host and waits for its reply. A request of
+   * a type already waiting is not sent again: it takes the reply owed to the
+   * earlier one, which is as fresh, since the host answers both with one.
+   *
+   * @param {ReplyRequestType} type
+   * @param {number} [timeoutMs]  How long to wait before rejecting.
+   * @returns {Promise<Record<string, unknown>>}  The reply message.
+   */
+  request(type, timeoutMs = 2000) {
+    const replyType = REPLY_TYPES[type];
+    if (!this.#port) {
+      return Promise.reject(new Error("native port is not connected"));
+    }
+
+    return new Promise((resolve, reject) => {
+      const queue = this.#pending.get(replyType) ?? [];
+      /** @type {PendingRequest} */
+      const entry = {
+        resolve,
+        reject,
+        timer: globalThis.setTimeout(() => {
+          const i = queue.indexOf(entry);
+          if (i !== -1) queue.splice(i, 1);
+          reject(new Error(`native ${type} request timed out`));
+        }, timeoutMs),
+      };
+      queue.push(entry);
+      this.#pending.set(replyType, queue);
+      if (queue.length === 1) this.send({ type });
+    });
+  }
+
+  /**
+   * @private
+   * Hands a typed reply to every request waiting for it.
+   *
+   * @param {unknown} m  The incoming message.
+   * @returns {boolean}  True if `m` was a reply, which callbacks never see.
+   */
+  #settleReply(m) {
+    if (m === null || typeof m !== "object") return false;
+    const reply = /** @type {Record<string, unknown>} */ (m);
+    if (typeof reply["type"] !== "string") return false;
+
+    const queue = this.#pending.get(reply["type"]);
+    if (queue) {
+      this.#pending.delete(reply["type"]);
+      for (const entry of queue) {
+        clearTimeout(entry.timer);
+        entry.resolve(reply);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @private
+   * Rejects every request still waiting, as their replies can no longer
+   * arrive.
+   *
+   * @returns {void}
+   */
+  #rejectPending() {
+    for (const queue of this.#pending.values()) {
+      for (const entry of queue) {
+        clearTimeout(entry.timer);
+        entry.reject(new Error("native port disconnected"));
+      }
+    }
+    this.#pending.clear();
+  }
+
   /**
    * Queues the next reconnect attempt using the current backoff delay with jitter.
    *
@@ -207,6 +315,7 @@ export class NativePort {
 
     this.#onMessageHandlerRef = (m) => {
       try {
+        if (this.#settleReply(m)) return;
         if (this.#onMessageCallback) this.#onMessageCallback(m);
       } catch (e) {
         console.error("onMessage callback error", e);
@@ -242,6 +351,7 @@ export class NativePort {
         this.#port = null;
         this.#onMessageHandlerRef = null;
         this.#onDisconnectHandlerRef = null;
+        this.#rejectPending();
         if (this.#shouldReconnect) this.scheduleReconnect();
       }
     };
@@ -0,0 +1,199 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Where the time went for one native message, from its arrival to the theme
+ * being applied.
+ * @typedef {Object} TraceEntry
+ * @property {number} seq  The host's sequence number, or -1 if it sent none.
+ * @property {number} receivedAt  Epoch milliseconds the message arrived.
+ * @property {number|null} transit
+ *   Milliseconds from the host's `sentAt` to arrival, or null without one.
+ * @property {Record<string, number>} spans
+ *   Milliseconds spent in each named span, plus `total` once committed.
+ * @property {number} start  performance.now() at arrival.
+ */
+
+/**
+ * What the options page reads back.
+ * @typedef {Object} TraceSnapshot
+ * @property {TraceEntry[]} entries  Oldest first.
+ * @property {number} dropped  Stale or out-of-order messages ignored.
+ * @property {number} capacity
+ */
+
+/**
+ * Times the stages each native message goes through as `performance`
+ * marks and measures, so they show up in the profiler, and keeps the last
+ * `capacity` messages' timings in a ring buffer for the options page.
+ */
+export class PerfTrace {
+  /** @private @readonly @type {string} */
+  static #PREFIX = "omarchy";
+
+  /** @private @readonly @type {number} */
+  #capacity;
+
+  /** @private @type {TraceEntry[]} */
+  #ring = [];
+
+  /**
+   * Index the next committed entry goes to once the ring is full.
+   * @private @type {number}
+   */
+  #next = 0;
+
+  /** @private @type {number} */
+  #dropped = 0;
+
+  /**
+   * @param {number} [capacity]  How many messages to keep.
+   */
+  constructor(capacity = 256) {
+    this.#capacity = Math.max(1, Math.floor(capacity));
+  }
+
+  /**
+   * Starts timing a message that just arrived, before it is parsed.
+   *
+   * @returns {TraceEntry}
+   */
+  begin() {
+    return {
+      seq: -1,
+      receivedAt: Date.now(),
+      transit: null,
+      spans: {},
+      start: performance.now(),
+    };
+  }
+
+  /**
+   * Fills in what the parsed message says about itself.
+   *
+   * @param {TraceEntry} entry
+   * @param {number|null} seq     The host's sequence number, if any.
+   * @param {number|null} sentAt  The host's send time in epoch ms, if any.
+   * @returns {void}
+   */
+  identify(entry, seq, sentAt) {
+    entry.seq = seq ?? -1;
+    entry.transit =
+      sentAt === null ? null : Math.max(0, entry.receivedAt - sentAt);
+  }
+
+  /**
+   * Runs `fn` as span `name` of `entry`. Without an entry `fn` just runs.
+   *
+   * @template T
+   * @param {TraceEntry|null} entry
+   * @param {string} name
+   * @param {() => T} fn
+   * @returns {T}
+   */
+  span(entry, name, fn) {
+    if (!entry) return fn();
+    const start = this.#mark(name);
+    try {
+      return fn();
+    } finally {
+      this.#measure(entry, name, start);
+    }
+  }
+
+  /**
+   * Like {@link PerfTrace#span}, for work that finishes asynchronously.
+   *
+   * @template T
+   * @param {TraceEntry|null} entry
+   * @param {string} name
+   * @param {() => Promise<T>} fn
+   * @returns {Promise<T>}
+   */
+  async spanAsync(entry, name, fn) {
+    if (!entry) return fn();
+    const start = this.#mark(name);
+    try {
+      return await fn();
+    } finally {
+      this.#measure(entry, name, start);
+    }
+  }
+
+  /**
+   * Stores a finished entry, replacing the oldest once the buffer is full.
+   *
+   * @param {TraceEntry} entry
+   * @returns {void}
+   */
+  commit(entry) {
+    entry.spans["total"] = performance.now() - entry.start;
+    if (this.#ring.length < this.#capacity) {
+      this.#ring.push(entry);
+      return;
+    }
+    this.#ring[this.#next] = entry;
+    this.#next = (this.#next + 1) % this.#capacity;
+  }
+
+  /**
+   * Counts a message that was ignored as stale or out of order.
+   *
+   * @returns {void}
+   */
+  noteDropped() {
+    this.#dropped++;
+  }
+
+  /**
+   * @returns {TraceSnapshot}
+   */
+  snapshot() {
+    return {
+      entries: [
+        ...this.#ring.slice(this.#next),
+        ...this.#ring.slice(0, this.#next),
+      ],
+      dropped: this.#dropped,
+      capacity: this.#capacity,
+    };
+  }
+
+  /**
+   * @private
+   * @param {string} name
+   * @returns {number}  performance.now() at the mark.
+   */
+  #mark(name) {
+    performance.mark(`${PerfTrace.#PREFIX}:${name}:start`);
+    return performance.now();
+  }
+
+  /**
+   * @private
+   * Records span `name` on `entry` and as a measure. Marks and measures are
+   * cleared right away so the performance timeline does not grow; the
+   * profiler has already seen them.
+   *
+   * @param {TraceEntry} entry
+   * @param {string} name
+   * @param {number} start  What #mark returned.
+   * @returns {void}
+   */
+  #measure(entry, name, start) {
+    entry.spans[name] = (entry.spans[name] ?? 0) + performance.now() - start;
+    const mark = `${PerfTrace.#PREFIX}:${name}:start`;
+    const measure = `${PerfTrace.#PREFIX}:${name}`;
+    try {
+      performance.measure(measure, mark);
+    } catch {
+      /* the mark is missing if a nested span cleared it */
+    }
+    performance.clearMarks(mark);
+    performance.clearMeasures(measure);
+  }
+}
@@ -0,0 +1,350 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * A finished theme, as returned by createFirefoxTheme.
+ * @typedef {import("./theme-creator/create-firefox-theme").FirefoxTheme} FirefoxTheme
+ */
+
+/**
+ * File layout, all integers little-endian:
+ *
+ *   magic       ATLAS_MAGIC
+ *   u32         THEME_ALGORITHM_VERSION the themes were built with
+ *   u8          steps per RGB axis; seed i on an axis is round(i*255/(steps-1))
+ *   u8          slot count, then per slot:
+ *                 u8 name length, name (ASCII), u8 source slot
+ *   per slot whose source is itself, in slot order:
+ *     u32       palette length, then that many r,g,b byte triples
+ *     u32       stream length, then the index stream
+ *   u32         stream length, then the index stream of ATLAS_SCHEMES indices
+ *
+ * A slot whose source is another slot holds the same color in every cell.
+ * Cells run red-major, then green, then blue. An index stream holds, per
+ * cell, the zigzag varint difference from the previous cell's index,
+ * starting from 0. A difference of 0 is followed by a varint count of the
+ * cells after it that repeat the index too.
+ */
+
+import { argbFromRgb } from "@material/material-color-utilities";
+import { isDark } from "./theme-creator/color-utils";
+
+export const ATLAS_MAGIC = "OFATLAS1";
+
+/** Color schemes in the order the scheme stream indexes them. */
+export const ATLAS_SCHEMES = /** @type {const} */ ([
+  "auto",
+  "light",
+  "dark",
+  "system",
+]);
+
+/**
+ * Reads the byte formats described above, throwing on anything cut off.
+ */
+class AtlasReader {
+  /** @private @readonly @type {Uint8Array} */
+  #bytes;
+
+  /** @private @type {number} */
+  #pos = 0;
+
+  /**
+   * @param {Uint8Array} bytes
+   */
+  constructor(bytes) {
+    this.#bytes = bytes;
+  }
+
+  /** @returns {number} */
+  u8() {
+    if (this.#pos >= this.#bytes.length) throw new Error("atlas is truncated");
+    return this.#bytes[this.#pos++];
+  }
+
+  /** @returns {number} */
+  u32() {
+    const lo = this.u8() | (this.u8() << 8) | (this.u8() << 16);
+    return lo + this.u8() * 2 ** 24;
+  }
+
+  /** @returns {number} */
+  varint() {
+    let v = 0;
+    for (let shift = 0; shift < 35; shift += 7) {
+      const b = this.u8();
+      v += (b & 0x7f) * 2 ** shift;
+      if (b < 0x80) return v;
+    }
+    throw new Error("atlas varint is too long");
+  }
+
+  /**
+   * @param {number} len
+   * @returns {Uint8Array}  A view, not a copy.
+   */
+  bytes(len) {
+    if (this.#pos + len > this.#bytes.length) {
+      throw new Error("atlas is truncated");
+    }
+    const view = this.#bytes.subarray(this.#pos, this.#pos + len);
+    this.#pos += len;
+    return view;
+  }
+
+  /** @returns {boolean} */
+  done() {
+    return this.#pos === this.#bytes.length;
+  }
+}
+
+/**
+ * Decodes one index stream.
+ *
+ * @param {Uint8Array} stream
+ * @param {number} cells
+ * @param {number} paletteLength  Indices must stay below this.
+ * @returns {Uint16Array|Uint32Array}
+ */
+function decodeIndices(stream, cells, paletteLength) {
+  const out =
+    paletteLength <= 0x10000 ? new Uint16Array(cells) : new Uint32Array(cells);
+  const r = new AtlasReader(stream);
+  let index = 0;
+  let cell = 0;
+  while (cell < cells) {
+    const z = r.varint();
+    const d = z % 2 === 1 ? -(z + 1) / 2 : z / 2;
+    index += d;
+    if (index < 0 || index >= paletteLength) {
+      throw new Error(`atlas index ${index} is out of range`);
+    }
+    const run = d === 0 ? 1 + r.varint() : 1;
+    if (cell + run > cells) throw new Error("atlas stream overruns its cells");
+    out.fill(index, cell, cell + run);
+    cell += run;
+  }
+  if (!r.done()) throw new Error("atlas stream has trailing bytes");
+  return out;
+}
+
+/**
+ * Themes precomputed over a grid of seed colors, to paint something close
+ * at once while the exact theme is built. Looking up a seed takes the
+ * nearest grid point's theme.
+ */
+export class ThemeAtlas {
+  /** @private @readonly @type {number} */
+  #steps;
+
+  /** @private @readonly @type {string[]} */
+  #names;
+
+  /**
+   * Per slot, "#rrggbb" strings; slots sharing a source share the array.
+   * @private @readonly @type {string[][]}
+   */
+  #palettes;
+
+  /** @private @readonly @type {(Uint16Array|Uint32Array)[]} */
+  #indices;
+
+  /** @private @readonly @type {Uint16Array|Uint32Array} */
+  #schemes;
+
+  /**
+   * @private
+   * @param {number} steps
+   * @param {string[]} names
+   * @param {string[][]} palettes
+   * @param {(Uint16Array|Uint32Array)[]} indices
+   * @param {Uint16Array|Uint32Array} schemes
+   */
+  constructor(steps, names, palettes, indices, schemes) {
+    this.#steps = steps;
+    this.#names = names;
+    this.#palettes = palettes;
+    this.#indices = indices;
+    this.#schemes = schemes;
+  }
+
+  /**
+   * Parses an atlas file.
+   *
+   * @param {ArrayBuffer} buf
+   * @param {number} version  The THEME_ALGORITHM_VERSION it must match.
+   * @returns {ThemeAtlas}
+   * @throws If the file is malformed or built by another version.
+   */
+  static decode(buf, version) {
+    const r = new AtlasReader(new Uint8Array(buf));
+    const magic = String.fromCharCode(...r.bytes(ATLAS_MAGIC.length));
+    if (magic !== ATLAS_MAGIC) throw new Error("not a theme atlas");
+    const built = r.u32();
+    if (built !== version) {
+      throw new Error(`atlas is for algorithm ${built}, not ${version}`);
+    }
+    const steps = r.u8();
+    if (steps < 2) throw new Error(`atlas has ${steps} steps per axis`);
+    const cells = steps ** 3;
+
+    const names = [];
+    const sources = [];
+    const count = r.u8();
+    for (let i = 0; i < count; i++) {
+      names.push(String.fromCharCode(...r.bytes(r.u8())));
+      const source = r.u8();
+      if (source > i) throw new Error(`atlas slot ${i} copies a later slot`);
+      sources.push(source);
+    }
+
+    /** @type {string[][]} */
+    const palettes = [];
+    /** @type {(Uint16Array|Uint32Array)[]} */
+    const indices = [];
+    for (let i = 0; i < count; i++) {
+      if (sources[i] !== i) {
+        palettes.push(palettes[sources[i]]);
+        indices.push(indices[sources[i]]);
+        continue;
+      }
+      const length = r.u32();
+      const rgb = r.bytes(length * 3);
+      const palette = new Array(length);
+      for (let p = 0; p < length; p++) {
+        const o = p * 3;
+        const packed = (rgb[o] << 16) | (rgb[o + 1] << 8) | rgb[o + 2];
+        palette[p] = "#" + packed.toString(16).padStart(6, "0");
+      }
+      palettes.push(palette);
+      indices.push(decodeIndices(r.bytes(r.u32()), cells, length));
+    }
+    const schemes = decodeIndices(
+      r.bytes(r.u32()),
+      cells,
+      ATLAS_SCHEMES.length,
+    );
+    if (!r.done()) throw new Error("atlas has trailing bytes");
+    return new ThemeAtlas(steps, names, palettes, indices, schemes);
+  }
+
+  /**
+   * Fetches and parses the atlas bundled with the extension.
+   *
+   * @param {string} url
+   * @param {number} version  The THEME_ALGORITHM_VERSION it must match.
+   * @returns {Promise<ThemeAtlas|null>}  Null if it is missing or unusable.
+   */
+  static async load(url, version) {
+    try {
+      const res = await fetch(url);
+      if (!res.ok) throw new Error(`${res.status} ${res.statusText}`);
+      return ThemeAtlas.decode(await res.arrayBuffer(), version);
+    } catch (e) {
+      console.warn("theme atlas unavailable", e);
+      return null;
+    }
+  }
+
+  /**
+   * The theme of the grid point nearest a seed color that is as dark as the
+   * seed, since that picks the color scheme and flips every slot with it.
+   *
+   * @param {number} r  0..255
+   * @param {number} g  0..255
+   * @param {number} b  0..255
+   * @returns {Readonly<FirefoxTheme>}
+   */
+  lookup(r, g, b) {
+    const n = this.#steps;
+    const [ri, gi, bi] = this.#nearest(r, g, b);
+    const cell = (ri * n + gi) * n + bi;
+
+    /** @type {Record<string, string>} */
+    const colors = {};
+    for (let i = 0; i < this.#names.length; i++) {
+      colors[this.#names[i]] = this.#palettes[i][this.#indices[i][cell]];
+    }
+    return Object.freeze({
+      colors: /** @type {FirefoxTheme["colors"]} */ (colors),
+      properties: { color_scheme: ATLAS_SCHEMES[this.#schemes[cell]] },
+    });
+  }
+
+  /**
+   * The seed the theme for `lookup(r, g, b)` was built from.
+   *
+   * @param {number} r  0..255
+   * @param {number} g  0..255
+   * @param {number} b  0..255
+   * @returns {[number, number, number]}
+   */
+  gridSeed(r, g, b) {
+    const [ri, gi, bi] = this.#nearest(r, g, b);
+    return [this.#axisSeed(ri), this.#axisSeed(gi), this.#axisSeed(bi)];
+  }
+
+  /**
+   * @private
+   * @param {number} i  Grid index on an axis.
+   * @returns {number}  The channel value built there.
+   */
+  #axisSeed(i) {
+    return Math.round((i * 255) / (this.#steps - 1));
+  }
+
+  /**
+   * @private
+   * @param {number} ri
+   * @param {number} gi
+   * @param {number} bi
+   * @returns {boolean}
+   */
+  #isDarkAt(ri, gi, bi) {
+    return isDark(
+      argbFromRgb(this.#axisSeed(ri), this.#axisSeed(gi), this.#axisSeed(bi)),
+    );
+  }
+
+  /**
+   * Grid indices for a seed: the nearest grid point, or the nearest corner
+   * of the grid cube around the seed that is as dark as the seed, if the
+   * nearest point is not and a corner is.
+   *
+   * @private
+   * @param {number} r
+   * @param {number} g
+   * @param {number} b
+   * @returns {[number, number, number]}
+   */
+  #nearest(r, g, b) {
+    const scale = (this.#steps - 1) / 255;
+    const x = [r * scale, g * scale, b * scale];
+    /** @type {[number, number, number]} */
+    const round = [Math.round(x[0]), Math.round(x[1]), Math.round(x[2])];
+    const dark = isDark(argbFromRgb(r, g, b));
+    if (this.#isDarkAt(...round) === dark) return round;
+
+    let best = round;
+    let bestDistance = Infinity;
+    for (let corner = 0; corner < 8; corner++) {
+      /** @type {[number, number, number]} */
+      const q = [0, 0, 0];
+      let distance = 0;
+      for (let axis = 0; axis < 3; axis++) {
+        q[axis] =
+          corner & (1 << axis) ? Math.ceil(x[axis]) : Math.floor(x[axis]);
+        distance += (x[axis] - q[axis]) ** 2;
+      }
+      if (distance < bestDistance && this.#isDarkAt(...q) === dark) {
+        best = q;
+        bestDistance = distance;
+      }
+    }
+    return best;
+  }
+}
@@ -0,0 +1,224 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * A finished theme, as returned by createFirefoxTheme.
+ * @typedef {import("./theme-creator/create-firefox-theme").FirefoxTheme} FirefoxTheme
+ */
+
+/**
+ * Hit/miss counters and occupancy of a ThemeCache.
+ * @typedef {Object} ThemeCacheStats
+ * @property {number} hits
+ * @property {number} misses
+ * @property {number} size
+ * @property {number} capacity
+ */
+
+/**
+ * The persisted shape of a ThemeCache, least recently used entry first.
+ * @typedef {Object} StoredThemeCache
+ * @property {number} version
+ * @property {[string, FirefoxTheme][]} entries
+ */
+
+/**
+ * Bounded LRU cache of built themes keyed by seed color, mirrored into
+ * `browser.storage.local` so it survives restarts. Entries built by another
+ * algorithm version are dropped on load.
+ */
+export class ThemeCache {
+  /** @private @readonly @type {string} */
+  static #STORAGE_KEY = "themeCache";
+
+  /** @private @readonly @type {number} */
+  #version;
+
+  /** @private @type {number} */
+  #capacity;
+
+  /**
+   * Map iteration order is insertion order, so the first key is always the
+   * least recently used one.
+   * @private @type {Map<string, Readonly<FirefoxTheme>>}
+   */
+  #entries = new Map();
+
+  /**
+   * Until the persisted entries are read, saving would overwrite them.
+   * @private @type {boolean}
+   */
+  #loaded = false;
+
+  /** @private @type {number} */
+  #hits = 0;
+
+  /** @private @type {number} */
+  #misses = 0;
+
+  /**
+   * @param {number} version   Algorithm version the cached themes belong to.
+   * @param {number} capacity  Maximum number of themes kept.
+   */
+  constructor(version, capacity) {
+    this.#version = version;
+    this.#capacity = ThemeCache.#validCapacity(capacity);
+  }
+
+  /**
+   * Restores entries persisted by a previous run. Entries from another
+   * algorithm version, or anything malformed, are discarded. Themes set
+   * before the load finished stay the most recently used.
+   *
+   * @returns {Promise<void>}
+   */
+  async load() {
+    /** @type {[string, Readonly<FirefoxTheme>][]} */
+    let newer = [];
+    try {
+      const stored = await browser.storage.local.get(ThemeCache.#STORAGE_KEY);
+      newer = [...this.#entries];
+      /** @type {StoredThemeCache|undefined} */
+      const raw = stored[ThemeCache.#STORAGE_KEY];
+      if (
+        !raw ||
+        raw.version !== this.#version ||
+        !Array.isArray(raw.entries)
+      ) {
+        return;
+      }
+      this.#entries.clear();
+      for (const entry of raw.entries) {
+        if (
+          Array.isArray(entry) &&
+          typeof entry[0] === "string" &&
+          entry[1] !== null &&
+          typeof entry[1] === "object"
+        ) {
+          this.#entries.delete(entry[0]);
+          this.#entries.set(entry[0], Object.freeze(entry[1]));
+        }
+      }
+      for (const [id, theme] of newer) {
+        this.#entries.delete(id);
+        this.#entries.set(id, theme);
+      }
+      this.#evict();
+    } catch (e) {
+      console.error("loading theme cache failed", e);
+    } finally {
+      this.#loaded = true;
+    }
+    if (newer.length > 0) await this.#save();
+  }
+
+  /**
+   * Looks up a theme and marks it most recently used.
+   *
+   * @param {string} id  Seed color ID, see rgbToID.
+   * @returns {Readonly<FirefoxTheme>|undefined}
+   */
+  get(id) {
+    const theme = this.#entries.get(id);
+    if (theme === undefined) {
+      this.#misses++;
+      return undefined;
+    }
+    this.#hits++;
+    this.#entries.delete(id);
+    this.#entries.set(id, theme);
+    return theme;
+  }
+
+  /**
+   * Stores a theme as most recently used and persists the cache.
+   *
+   * @param {string} id  Seed color ID, see rgbToID.
+   * @param {Readonly<FirefoxTheme>} theme
+   * @returns {Promise<void>}
+   */
+  async set(id, theme) {
+    this.#entries.delete(id);
+    this.#entries.set(id, Object.freeze(theme));
+    this.#evict();
+    await this.#save();
+  }
+
+  /**
+   * Changes the capacity, evicting least recently used entries if needed.
+   *
+   * @param {number} capacity
+   * @returns {Promise<void>}
+   */
+  async setCapacity(capacity) {
+    this.#capacity = ThemeCache.#validCapacity(capacity);
+    if (this.#evict()) await this.#save();
+  }
+
+  /**
+   * @returns {ThemeCacheStats}
+   */
+  stats() {
+    return {
+      hits: this.#hits,
+      misses: this.#misses,
+      size: this.#entries.size,
+      capacity: this.#capacity,
+    };
+  }
+
+  /**
+   * Drops least recently used entries above capacity.
+   *
+   * @private
+   * @returns {boolean}  True if anything was evicted.
+   */
+  #evict() {
+    let evicted = false;
+    while (this.#entries.size > this.#capacity) {
+      const oldest = this.#entries.keys().next().value;
+      this.#entries.delete(/** @type {string} */ (oldest));
+      evicted = true;
+    }
+    return evicted;
+  }
+
+  /**
+   * @private
+   * @returns {Promise<void>}
+   */
+  async #save() {
+    if (!this.#loaded) return;
+    /** @type {StoredThemeCache} */
+    const stored = {
+      version: this.#version,
+      entries: [...this.#entries],
+    };
+    try {
+      await browser.storage.local.set({ [ThemeCache.#STORAGE_KEY]: stored });
+    } catch (e) {
+      console.error("saving theme cache failed", e);
+    }
+  }
+
+  /**
+   * @private
+   * @param {unknown} capacity
+   * @returns {number}
+   * @throws If capacity is not a positive integer.
+   */
+  static #validCapacity(capacity) {
+    if (
+      typeof capacity !== "number" ||
+      !Number.isInteger(capacity) ||
+      capacity < 1
+    ) {
+      throw new Error(`theme cache capacity '${capacity}' is not positive`);
+    }
+    return capacity;
+  }
+}
@@ -0,0 +1,219 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+import { createFirefoxTheme } from "./theme-creator";
+
+/**
+ * @typedef {[number, number, number]} RGB
+ * @typedef {import("./theme-creator/create-firefox-theme").FirefoxTheme} FirefoxTheme
+ */
+
+/**
+ * What the background page posts to the worker.
+ *
+ * @typedef {{type: "create", id: number, rgb: RGB}
+ *   | {type: "cancel", id: number}} WorkerRequest
+ */
+
+/**
+ * What the worker posts back, one per create request it gets to.
+ *
+ * @typedef {{id: number, theme: FirefoxTheme}
+ *   | {id: number, error: string}} WorkerResponse
+ */
+
+/**
+ * The request the client is waiting on.
+ *
+ * @typedef PendingCreate
+ * @type {object}
+ * @property {number} id
+ * @property {RGB} rgb
+ * @property {(theme: Readonly<FirefoxTheme>) => void} resolve
+ * @property {(err: Error) => void} reject
+ * @property {() => void} unlisten  Removes the abort listener, if any.
+ */
+
+/**
+ * Builds themes with createFirefoxTheme in a dedicated worker, so palette
+ * generation and contrast solving do not hold up the background page.
+ *
+ * Requests are latest-wins: a new one cancels the one in flight, whose
+ * promise rejects with an "AbortError" DOMException. Where workers are not
+ * available, or the worker fails to load, themes are built in place.
+ */
+export class ThemeWorker {
+  /** @private @readonly @type {string} */
+  #url;
+
+  /** @private @type {Worker|null} */
+  #worker = null;
+
+  /** @private @type {boolean} */
+  #broken = typeof Worker === "undefined";
+
+  /** @private @type {number} */
+  #nextID = 1;
+
+  /** @private @type {PendingCreate|null} */
+  #pending = null;
+
+  /**
+   * @param {string} [url]  The bundled theme-worker.js, relative to the page.
+   */
+  constructor(url = "theme-worker.js") {
+    this.#url = url;
+  }
+
+  /**
+   * Builds the theme for a seed color, cancelling any request in flight.
+   *
+   * @param {RGB} rgb
+   * @param {AbortSignal} [signal]  Cancels this request when aborted.
+   * @returns {Promise<Readonly<FirefoxTheme>>}
+   * @throws {DOMException} "AbortError" when cancelled or superseded.
+   */
+  create(rgb, signal) {
+    this.#cancel();
+    if (signal?.aborted) return Promise.reject(abortError());
+
+    const worker = this.#ensureWorker();
+    if (!worker) {
+      try {
+        return Promise.resolve(createFirefoxTheme(...rgb));
+      } catch (e) {
+        return Promise.reject(e);
+      }
+    }
+
+    const id = this.#nextID++;
+    return new Promise((resolve, reject) => {
+      const onAbort = () => {
+        if (this.#pending?.id === id) this.#cancel();
+      };
+      signal?.addEventListener("abort", onAbort, { once: true });
+      this.#pending = {
+        id,
+        rgb,
+        resolve,
+        reject,
+        unlisten: () => signal?.removeEventListener("abort", onAbort),
+      };
+      worker.postMessage(
+        /** @type {WorkerRequest} */ ({ type: "create", id, rgb: [...rgb] }),
+      );
+    });
+  }
+
+  /**
+   * Stops the worker. Any request in flight is cancelled.
+   *
+   * @returns {void}
+   */
+  terminate() {
+    this.#cancel();
+    this.#worker?.terminate();
+    this.#worker = null;
+  }
+
+  /**
+   * @private
+   * @returns {Worker|null}  The worker, started on first use, or null when
+   *   themes have to be built in place.
+   */
+  #ensureWorker() {
+    if (this.#worker || this.#broken) return this.#worker;
+    try {
+      const worker = new Worker(this.#url);
+      worker.onmessage = (e) => this.#onResponse(e.data);
+      worker.onerror = (e) => this.#onError(e);
+      this.#worker = worker;
+    } catch (e) {
+      console.error("theme worker unavailable, building in place", e);
+      this.#broken = true;
+    }
+    return this.#worker;
+  }
+
+  /**
+   * @private
+   * @param {WorkerResponse} res
+   * @returns {void}
+   */
+  #onResponse(res) {
+    const p = this.#pending;
+    // replies to requests already cancelled are dropped
+    if (!p || p.id !== res.id) return;
+    this.#pending = null;
+    p.unlisten();
+    if ("theme" in res) {
+      p.resolve(Object.freeze(res.theme));
+    } else {
+      p.reject(new Error(res.error));
+    }
+  }
+
+  /**
+   * The worker failed to load or threw outside a request. It is not used
+   * again and the request in flight is rebuilt in place.
+   *
+   * @private
+   * @param {ErrorEvent} e
+   * @returns {void}
+   */
+  #onError(e) {
+    console.error("theme worker failed, building in place", e.message);
+    e.preventDefault();
+    this.#broken = true;
+    this.#worker?.terminate();
+    this.#worker = null;
+
+    const p = this.#pending;
+    if (!p) return;
+    this.#pending = null;
+    p.unlisten();
+    try {
+      p.resolve(createFirefoxTheme(...p.rgb));
+    } catch (err) {
+      p.reject(/** @type {Error} */ (err));
+    }
+  }
+
+  /**
+   * Rejects the request in flight and tells the worker to skip it.
+   *
+   * @private
+   * @returns {void}
+   */
+  #cancel() {
+    const p = this.#pending;
+    if (!p) return;
+    this.#pending = null;
+    p.unlisten();
+    this.#worker?.postMessage(
+      /** @type {WorkerRequest} */ ({ type: "cancel", id: p.id }),
+    );
+    p.reject(abortError());
+  }
+}
+
+/**
+ * Checks whether an error is a cancelled {@link ThemeWorker#create}.
+ *
+ * @param {unknown} e
+ * @returns {boolean}
+ */
+export function isAbortError(e) {
+  return e instanceof DOMException && e.name === "AbortError";
+}
+
+/**
+ * @returns {DOMException}
+ */
+function abortError() {
+  return new DOMException("theme request cancelled", "AbortError");
+}
@@ -5,23 +5,113 @@
  * see the LICENSE file for details
  */
 
+import { ApplyScheduler } from "./ApplyScheduler";
 import { NativePort } from "./NativePort";
-import { createFirefoxTheme } from "./theme-creator";
+import { PerfTrace } from "./PerfTrace";
+import { ThemeAtlas } from "./ThemeAtlas";
+import { ThemeCache } from "./ThemeCache";
+import {
+  createApproximateTheme,
+  THEME_ALGORITHM_VERSION,
+  themeDistance,
+} from "./theme-creator";
+import { isAbortError, ThemeWorker } from "./ThemeWorker";
 
 const FALLBACK_COLOR = /** @type {RGB} */ ([28, 32, 39]);
 
+// browser.storage.local key of the last applied theme, see ThemeSnapshot
+const SNAPSHOT_KEY = "lastTheme";
+
+// browser.storage.local key overriding THEME_CACHE_CAPACITY
+const CACHE_CAPACITY_KEY = "themeCacheCapacity";
+const THEME_CACHE_CAPACITY = 16;
+
+// browser.storage.local key capping theme applies per second, e.g. to the
+// display's refresh rate; unset or 0 applies as fast as updates finish
+const APPLY_RATE_KEY = "maxApplyRate";
+
+// browser.storage.local key overriding RESTYLE_THRESHOLD
+const RESTYLE_THRESHOLD_KEY = "restyleThreshold";
+// themes closer than this in Oklab ΔE, on every color slot, to the one on
+// screen are not applied; about half of what is just noticeable
+const RESTYLE_THRESHOLD = 0.01;
+
+// precomputed themes bundled in the XPI, see scripts/build-theme-atlas.js
+const THEME_ATLAS_FILE = "theme-atlas.bin";
+
+// native messages whose timings are kept for the options page
+const PERF_TRACE_CAPACITY = 256;
+
+// runtime message the options page sends for a TraceSnapshot
+const PERF_TRACE_REQUEST = "perfTrace";
+
+// runtime message the options page sends for a StatsSnapshot
+const STATS_REQUEST = "stats";
+
 /**
  * An RGB triplet with each channel in 0–255.
  * @typedef {[number, number, number]} RGB
  */
 
+/**
+ * A finished theme, as returned by createFirefoxTheme.
+ * @typedef {import("./theme-creator/create-firefox-theme").FirefoxTheme} FirefoxTheme
+ */
+
 /**
  * The parsed shape of a native response.
  * @typedef {Object} ParsedMessage
  * @property {RGB|null} rgb     The color tuple or null if missing/invalid.
+ * @property {Readonly<FirefoxTheme>|null} theme
+ *   Theme built by the native host, or null if it did not send one.
  * @property {string|null} error An error string if the host reported one.
+ * @property {number|null} seq   The host's sequence number for the message.
+ * @property {number|null} sentAt
+ *   When the host sent it, in epoch milliseconds.
+ */
+
+/**
+ * Counters shown on the options page.
+ * @typedef {Object} StatsSnapshot
+ * @property {import("./ThemeCache").ThemeCacheStats} themeCache
+ * @property {import("./ApplyScheduler").ApplySchedulerStats} applyScheduler
+ * @property {Record<string, unknown>|null} host
+ *   The native host's reply to a stats request, or null if it did not answer.
+ * @property {string|null} hostError  Why the host did not answer.
+ */
+
+/**
+ * The last applied theme and the color it was built from, as persisted in
+ * browser.storage.local.
+ * @typedef {Object} ThemeSnapshot
+ * @property {number} version  THEME_ALGORITHM_VERSION the theme was built with.
+ * @property {RGB} rgb
+ * @property {Readonly<FirefoxTheme>} theme
  */
 
+const HEX_COLOR = /^#[0-9a-f]{6}$/;
+
+const THEME_COLOR_KEYS = /** @type {const} */ ([
+  "toolbar",
+  "toolbar_text",
+  "frame",
+  "tab_background_text",
+  "toolbar_field",
+  "toolbar_field_text",
+  "tab_line",
+  "popup",
+  "popup_text",
+  "button_background_hover",
+  "icons",
+  "toolbar_field_border_focus",
+  "toolbar_field_border",
+  "toolbar_field_focus",
+  "toolbar_field_highlight_text",
+  "toolbar_field_highlight",
+]);
+
+const COLOR_SCHEMES = ["auto", "light", "dark", "system"];
+
 /**
  * Checks whether a value is an integer in the 0–255 range.
  *
@@ -59,13 +149,75 @@ function parseMessage(raw) {
 
   const rgb = parseRGB(anyRaw["rgb"]);
 
+  const theme = anyRaw.hasOwnProperty("theme")
+    ? parseTheme(anyRaw["theme"])
+    : null;
+
+  const seq = parseOptionalNumber(anyRaw, "seq");
+  const sentAt = parseOptionalNumber(anyRaw, "sentAt");
+
   const errVal = anyRaw.hasOwnProperty("error") ? anyRaw["error"] : null;
   if (typeof errVal === "string" || errVal === null) {
-    return { rgb, error: errVal };
+    return { rgb, theme, error: errVal, seq, sentAt };
   }
   throw new Error("message.error is not a string or null");
 }
 
+/**
+ * Reads a number member that older hosts do not send.
+ *
+ * @param {Record<string, unknown>} raw
+ * @param {string} key
+ * @returns {number|null}  The value, or null if it is missing.
+ * @throws If the member is present but not a finite number.
+ */
+function parseOptionalNumber(raw, key) {
+  if (!raw.hasOwnProperty(key)) return null;
+  const v = raw[key];
+  if (typeof v === "number" && Number.isFinite(v)) return v;
+  throw new Error(`message.${key} is not a number`);
+}
+
+/**
+ * Validates a theme built by the native host.
+ *
+ * @param {unknown} raw
+ * @returns {Readonly<FirefoxTheme>}
+ * @throws If raw does not have the shape of a FirefoxTheme.
+ */
+function parseTheme(raw) {
+  if (raw === null || typeof raw !== "object" || Array.isArray(raw)) {
+    throw new Error("message.theme is not an object");
+  }
+
+  /** @type {Record<string, any>} */
+  const anyRaw = raw;
+  const colors = anyRaw["colors"];
+  const properties = anyRaw["properties"];
+
+  if (colors === null || typeof colors !== "object") {
+    throw new Error("message.theme.colors is not an object");
+  }
+  for (const key of THEME_COLOR_KEYS) {
+    const v = colors[key];
+    if (typeof v !== "string" || !HEX_COLOR.test(v)) {
+      throw new Error(`message.theme.colors.${key} '${v}' is not #rrggbb`);
+    }
+  }
+  if (
+    properties === null ||
+    typeof properties !== "object" ||
+    !COLOR_SCHEMES.includes(properties["color_scheme"])
+  ) {
+    throw new Error("message.theme.properties.color_scheme is invalid");
+  }
+
+  return Object.freeze({
+    colors: Object.fromEntries(THEME_COLOR_KEYS.map((k) => [k, colors[k]])),
+    properties: { color_scheme: properties["color_scheme"] },
+  });
+}
+
 /**
  * Validates and returns an RGB array.
  *
@@ -88,36 +240,236 @@ function parseRGB(raw) {
 
 let lastAppliedID = /** @type {string|null} */ (null);
 
+// the theme on screen, which lastAppliedID may only resemble
+let lastAppliedTheme = /** @type {Readonly<FirefoxTheme>|null} */ (null);
+
+let restyleThreshold = RESTYLE_THRESHOLD;
+
+// the newest message seen, by the host's numbering
+let lastSeq = -1;
+let lastSentAt = -Infinity;
+
+const perfTrace = new PerfTrace(PERF_TRACE_CAPACITY);
+
 /**
- * Builds a theme from RGB and applies it if it’s new.
+ * Checks whether a message is older than one already seen, and notes it as
+ * the newest otherwise. A restarted host numbers from 1 again but sends later
+ * times, and the latest message resent on request keeps its number, so
+ * neither counts as stale.
  *
- * @param {RGB} rgb
- * @returns {Promise<void>}
+ * @param {ParsedMessage} msg
+ * @returns {boolean}
  */
-async function buildAndApply(rgb) {
-  const id = rgbToID(rgb);
-  if (id === lastAppliedID) return;
+function isStale(msg) {
+  if (msg.seq === null) return false;
+  if (msg.seq < lastSeq && (msg.sentAt ?? -Infinity) <= lastSentAt) {
+    return true;
+  }
+  lastSeq = msg.seq;
+  lastSentAt = msg.sentAt ?? lastSentAt;
+  return false;
+}
+
+const themeCache = new ThemeCache(
+  THEME_ALGORITHM_VERSION,
+  THEME_CACHE_CAPACITY,
+);
+
+const themeWorker = new ThemeWorker();
 
-  const theme = createFirefoxTheme(...rgb);
+const applyScheduler = new ApplyScheduler();
 
+// null until loaded, and for builds without an atlas
+let themeAtlas = /** @type {ThemeAtlas|null} */ (null);
+
+// started by the first theme built here, which the bundled host, sending
+// its own, never needs
+let themeAtlasLoad = /** @type {Promise<void>|null} */ (null);
+
+/**
+ * Whether a theme looks different from the one on screen, if any.
+ *
+ * @param {Readonly<FirefoxTheme>} theme
+ * @returns {boolean}
+ */
+function looksDifferent(theme) {
+  return (
+    !lastAppliedTheme ||
+    themeDistance(theme, lastAppliedTheme) > restyleThreshold
+  );
+}
+
+/**
+ * Restyles the browser with a theme unless it looks the same as the one on
+ * screen: nearby seeds often map to the same tones, and a restyle nobody can
+ * see still costs the whole browser chrome a frame.
+ *
+ * @param {Readonly<FirefoxTheme>} theme
+ * @param {import("./PerfTrace").TraceEntry|null} trace
+ * @param {string} span  What to time the update as.
+ * @returns {Promise<boolean>}  True if it restyled.
+ */
+async function restyle(theme, trace, span) {
+  if (!looksDifferent(theme)) return false;
   try {
-    browser.theme.update(theme);
+    await perfTrace.spanAsync(trace, span, () => browser.theme.update(theme));
   } catch (e) {
     console.error("browser.theme.update failed", e);
     throw e;
   }
+  lastAppliedTheme = theme;
+  return true;
+}
+
+/**
+ * A theme close to createFirefoxTheme's that is ready at once: the atlas's,
+ * or an HSL approximation until the atlas has loaded or if there is none.
+ * The first call starts loading the atlas.
+ *
+ * @param {RGB} rgb
+ * @param {import("./PerfTrace").TraceEntry|null} trace
+ * @returns {Readonly<FirefoxTheme>}
+ */
+function roughTheme(rgb, trace) {
+  if (themeAtlas) return themeAtlas.lookup(...rgb);
+  loadThemeAtlas();
+  return perfTrace.span(trace, "approximate", () =>
+    createApproximateTheme(...rgb),
+  );
+}
+
+/**
+ * Builds a theme from RGB, or takes it from the cache, and applies it if
+ * it’s new and looks different from the one on screen. An uncached theme is
+ * applied in two tiers: a rough one at once, then the exact one once built,
+ * if it looks different. Gives up quietly if a newer color's build cancels
+ * this one. Only themes built here are cached; the host's cost nothing to
+ * take again.
+ * Only call it through {@link scheduleApply}, which keeps applies in order.
+ *
+ * @param {RGB} rgb
+ * @param {Readonly<FirefoxTheme>|null} [prebuilt]  Theme already built by the native host.
+ * @param {import("./PerfTrace").TraceEntry|null} [trace]  Where to time the steps.
+ * @param {AbortSignal} [signal]  Aborted once a newer color is waiting.
+ * @returns {Promise<void>}
+ */
+async function buildAndApply(rgb, prebuilt = null, trace = null, signal) {
+  const id = rgbToID(rgb);
+  // the host's theme for a color changes when an upgrade changes how themes
+  // are built, so it is compared by looks rather than by color
+  if (id === lastAppliedID && !(prebuilt && looksDifferent(prebuilt))) return;
+
+  const cached = prebuilt ? undefined : themeCache.get(id);
+  let theme = prebuilt ?? cached;
+  const built = !theme;
+  let restyled = false;
+  if (!theme) {
+    restyled = await restyle(roughTheme(rgb, trace), trace, "firstPaint");
+    try {
+      theme = await perfTrace.spanAsync(trace, "create", () =>
+        themeWorker.create(rgb, signal),
+      );
+    } catch (e) {
+      if (isAbortError(e)) return;
+      throw e;
+    }
+  }
+  // the newer color will restyle anyway, so skip paying for this one
+  if (signal?.aborted) return;
+
+  // the exact theme replaces the rough one only if it looks different
+  if (await restyle(theme, trace, "update")) restyled = true;
 
   lastAppliedID = id;
+  if (built) await themeCache.set(id, theme);
+  // a skipped restyle still moves lastAppliedID, so the snapshot follows it
+  // with the theme left on screen; the next launch would otherwise start
+  // from the previous color and take this one again
+  const shown = restyled ? theme : (lastAppliedTheme ?? theme);
+  await saveSnapshot({ version: THEME_ALGORITHM_VERSION, rgb, theme: shown });
+}
+
+/**
+ * Applies a color after the apply in progress, if any. A color still waiting
+ * when a newer one arrives is never applied.
+ *
+ * @param {RGB} rgb
+ * @param {Readonly<FirefoxTheme>|null} [prebuilt]  Theme already built by the native host.
+ * @param {import("./PerfTrace").TraceEntry|null} [trace]  Where to time the steps.
+ * @returns {Promise<boolean>}  False if a newer color replaced this one.
+ */
+function scheduleApply(rgb, prebuilt = null, trace = null) {
+  return applyScheduler.schedule((signal) =>
+    buildAndApply(rgb, prebuilt, trace, signal),
+  );
+}
+
+// the stored snapshot, as read at startup or last saved
+let savedSnapshot = /** @type {ThemeSnapshot|null} */ (null);
+
+/**
+ * Persists the theme that was just applied so the next launch can start
+ * with it. Applying the stored snapshot itself writes nothing.
+ *
+ * @param {ThemeSnapshot} snapshot
+ * @returns {Promise<void>}
+ */
+async function saveSnapshot(snapshot) {
+  if (
+    savedSnapshot &&
+    snapshot.theme === savedSnapshot.theme &&
+    rgbToID(snapshot.rgb) === rgbToID(savedSnapshot.rgb)
+  ) {
+    return;
+  }
+  savedSnapshot = snapshot;
+  try {
+    await browser.storage.local.set({ [SNAPSHOT_KEY]: snapshot });
+  } catch (e) {
+    console.error("saving theme snapshot failed", e);
+  }
+}
+
+/**
+ * Validates the persisted theme, if any. A theme built by another
+ * THEME_ALGORITHM_VERSION is ignored.
+ *
+ * @param {unknown} raw  The stored SNAPSHOT_KEY value.
+ * @returns {ThemeSnapshot|null}
+ */
+function parseSnapshot(raw) {
+  try {
+    if (raw === undefined) return null;
+    if (raw === null || typeof raw !== "object") {
+      throw new Error("snapshot is not an object");
+    }
+    /** @type {Record<string, any>} */
+    const anyRaw = raw;
+    if (anyRaw["version"] !== THEME_ALGORITHM_VERSION) return null;
+    return {
+      version: THEME_ALGORITHM_VERSION,
+      rgb: parseRGB(anyRaw["rgb"]),
+      theme: parseTheme(anyRaw["theme"]),
+    };
+  } catch (e) {
+    console.error("ignoring stored theme snapshot", e);
+    return null;
+  }
 }
 
 /**
  * Applies the last-saved or fallback theme.
  *
+ * @param {ThemeSnapshot|null} snapshot
  * @returns {Promise<void>}
  */
-async function applyFallback() {
+async function applyFallback(snapshot) {
   try {
-    await buildAndApply(FALLBACK_COLOR);
+    if (snapshot) {
+      await scheduleApply(snapshot.rgb, snapshot.theme);
+    } else {
+      await scheduleApply(FALLBACK_COLOR);
+    }
   } catch (e) {
     console.error("applyFallback failed", e);
   }
@@ -126,40 +478,168 @@ async function applyFallback() {
 const native = new NativePort();
 
 native.onMessage(async (raw) => {
+  const trace = perfTrace.begin();
   try {
-    const msg = parseMessage(raw);
+    const msg = perfTrace.span(trace, "parse", () => parseMessage(raw));
+    perfTrace.identify(trace, msg.seq, msg.sentAt);
+    if (isStale(msg)) {
+      perfTrace.noteDropped();
+      return;
+    }
     if (msg.error) console.error("native reported error", msg.error);
     if (msg.rgb) {
-      await buildAndApply(msg.rgb);
+      await scheduleApply(msg.rgb, msg.theme, trace);
     }
+    perfTrace.commit(trace);
   } catch (e) {
     console.error("failed to parse or apply native message", e);
   }
 });
 
+browser.runtime.onMessage.addListener((message) => {
+  if (message?.type === PERF_TRACE_REQUEST) {
+    return Promise.resolve(perfTrace.snapshot());
+  }
+  if (message?.type === STATS_REQUEST) {
+    return statsSnapshot();
+  }
+  return undefined;
+});
+
+/**
+ * Gathers the counters shown on the options page, the host's included.
+ *
+ * @returns {Promise<StatsSnapshot>}
+ */
+async function statsSnapshot() {
+  /** @type {StatsSnapshot} */
+  const stats = {
+    themeCache: themeCache.stats(),
+    applyScheduler: applyScheduler.stats(),
+    host: null,
+    hostError: null,
+  };
+  try {
+    const reply = await native.request("stats");
+    const host = reply["stats"];
+    if (host === null || typeof host !== "object") {
+      throw new Error("stats reply has no stats object");
+    }
+    stats.host = /** @type {Record<string, unknown>} */ (host);
+  } catch (e) {
+    stats.hostError = String(e);
+  }
+  return stats;
+}
+
+/**
+ * Reads the settings and the saved theme in one storage round trip.
+ *
+ * @returns {Promise<Record<string, unknown>>}  Empty if reading failed.
+ */
+async function readStartupState() {
+  try {
+    return await browser.storage.local.get([
+      SNAPSHOT_KEY,
+      CACHE_CAPACITY_KEY,
+      APPLY_RATE_KEY,
+      RESTYLE_THRESHOLD_KEY,
+    ]);
+  } catch (e) {
+    console.error("reading stored settings failed", e);
+    return {};
+  }
+}
+
+/**
+ * Applies the user-set theme cache capacity, cap on theme applies per
+ * second and restyle threshold found in `stored`, if any. A threshold of 0
+ * skips only identical themes.
+ *
+ * @param {Record<string, unknown>} stored  See readStartupState.
+ * @returns {Promise<void>}
+ */
+async function applySettings(stored) {
+  try {
+    const capacity = stored[CACHE_CAPACITY_KEY];
+    if (capacity !== undefined) {
+      await themeCache.setCapacity(/** @type {number} */ (capacity));
+    }
+  } catch (e) {
+    console.error("ignoring stored theme cache capacity", e);
+  }
+
+  try {
+    const rate = stored[APPLY_RATE_KEY];
+    if (rate !== undefined) applyScheduler.setMaxRate(rate);
+  } catch (e) {
+    console.error("ignoring stored apply rate", e);
+  }
+
+  try {
+    const threshold = stored[RESTYLE_THRESHOLD_KEY];
+    if (threshold === undefined) return;
+    if (typeof threshold !== "number" || !(threshold >= 0)) {
+      throw new Error(`restyle threshold '${threshold}' is not >= 0`);
+    }
+    restyleThreshold = threshold;
+  } catch (e) {
+    console.error("ignoring stored restyle threshold", e);
+  }
+}
+
+/**
+ * Starts loading the bundled theme atlas, unless that has already begun.
+ * themeAtlas stays null if it is missing.
+ *
+ * @returns {void}
+ */
+function loadThemeAtlas() {
+  themeAtlasLoad ??= ThemeAtlas.load(
+    browser.runtime.getURL(THEME_ATLAS_FILE),
+    THEME_ALGORITHM_VERSION,
+  ).then((atlas) => {
+    themeAtlas = atlas;
+  });
+}
+
 /**
- * Initializes native port and applies saved/fallback theme.
+ * Applies the saved/fallback theme, then initializes the native port. The
+ * saved theme is applied first so the host's first message is a no-op when
+ * the omarchy theme has not changed since the last run. Settings come in the
+ * same storage round trip as the saved theme and are applied after it. The
+ * theme cache is read last, as the saved theme and the host's never need it.
  *
  * @returns {Promise<void>}
  */
 async function init() {
+  const stored = await readStartupState();
+  savedSnapshot = parseSnapshot(stored[SNAPSHOT_KEY]);
+  await applyFallback(savedSnapshot);
+  await applySettings(stored);
   try {
     native.start();
   } catch (e) {
     console.error("native.start failed", e);
   }
-  await applyFallback();
+  await themeCache.load();
 }
 
 if (
   typeof browser.runtime?.onSuspend === "object" &&
   browser.runtime.onSuspend
 ) {
-  browser.runtime.onSuspend.addListener(() => native.stop());
+  browser.runtime.onSuspend.addListener(() => {
+    native.stop();
+    themeWorker.terminate();
+  });
 }
 
 if (typeof window !== "undefined") {
-  window.addEventListener("unload", () => native.stop());
+  window.addEventListener("unload", () => {
+    native.stop();
+    themeWorker.terminate();
+  });
 }
 
 void init();
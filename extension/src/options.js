@@ -0,0 +1,222 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/** @typedef {import("./PerfTrace").TraceSnapshot} TraceSnapshot */
+/** @typedef {import("./PerfTrace").TraceEntry} TraceEntry */
+/** @typedef {import("./background").StatsSnapshot} StatsSnapshot */
+
+// spans shown, in the order a message goes through them
+const SPANS = [
+  "transit",
+  "parse",
+  "approximate",
+  "firstPaint",
+  "create",
+  "update",
+  "total",
+];
+
+// bucket i holds times up to 2^i ms, from under 1/16 ms up; the last bucket
+// holds everything slower
+const FIRST_BUCKET_LOG2 = -4;
+const BUCKETS = 16;
+
+const BAR_WIDTH_EM = 12;
+
+/**
+ * Reads one span's time off an entry.
+ *
+ * @param {TraceEntry} entry
+ * @param {string} name
+ * @returns {number|undefined}  Milliseconds, or undefined if it did not run.
+ */
+function spanTime(entry, name) {
+  if (name === "transit") return entry.transit ?? undefined;
+  return entry.spans[name];
+}
+
+/**
+ * Counts times into log2 millisecond buckets.
+ *
+ * @param {number[]} times
+ * @returns {number[]}
+ */
+function histogram(times) {
+  const counts = new Array(BUCKETS).fill(0);
+  for (const t of times) {
+    const log = t > 0 ? Math.ceil(Math.log2(t)) : FIRST_BUCKET_LOG2;
+    const i = Math.min(BUCKETS - 1, Math.max(0, log - FIRST_BUCKET_LOG2));
+    counts[i]++;
+  }
+  return counts;
+}
+
+/**
+ * @param {number[]} sorted  Ascending.
+ * @param {number} p  In 0–1.
+ * @returns {number}
+ */
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+}
+
+/**
+ * @param {number} ms
+ * @returns {string}
+ */
+function formatMs(ms) {
+  return ms < 10 ? ms.toFixed(2) : ms.toFixed(0);
+}
+
+/**
+ * Builds a table row of text cells.
+ *
+ * @param {string} tag  "td" or "th".
+ * @param {(string|Node)[]} cells
+ * @returns {HTMLTableRowElement}
+ */
+function row(tag, cells) {
+  const tr = document.createElement("tr");
+  for (const c of cells) {
+    const cell = document.createElement(tag);
+    cell.append(c);
+    tr.append(cell);
+  }
+  return tr;
+}
+
+/**
+ * Renders a histogram table for one span.
+ *
+ * @param {string} name
+ * @param {number[]} times
+ * @returns {HTMLElement}
+ */
+function renderSpan(name, times) {
+  const section = document.createElement("section");
+  const heading = document.createElement("h3");
+  section.append(heading);
+  if (times.length === 0) {
+    heading.textContent = `${name}: no samples`;
+    return section;
+  }
+
+  const sorted = [...times].sort((a, b) => a - b);
+  heading.textContent =
+    `${name}: p50 ${formatMs(percentile(sorted, 0.5))} ms, ` +
+    `p99 ${formatMs(percentile(sorted, 0.99))} ms, ` +
+    `max ${formatMs(sorted[sorted.length - 1])} ms`;
+
+  const counts = histogram(times);
+  const most = Math.max(...counts);
+  const table = document.createElement("table");
+  table.append(row("th", ["up to", "count", ""]));
+  for (let i = 0; i < BUCKETS; i++) {
+    if (counts[i] === 0) continue;
+    const bar = document.createElement("span");
+    bar.className = "bar";
+    bar.style.width = `${(counts[i] / most) * BAR_WIDTH_EM}em`;
+    const limit =
+      i === BUCKETS - 1 ? "slower" : `${2 ** (i + FIRST_BUCKET_LOG2)} ms`;
+    table.append(row("td", [limit, String(counts[i]), bar]));
+  }
+  section.append(table);
+  return section;
+}
+
+/**
+ * Describes the background page's counters, one line each.
+ *
+ * @param {StatsSnapshot} stats
+ * @returns {string[]}
+ */
+function statsLines(stats) {
+  const c = stats.themeCache;
+  const a = stats.applyScheduler;
+  return [
+    `theme cache: ${c.size} of ${c.capacity} themes, ` +
+      `${c.hits} hits, ${c.misses} misses`,
+    `applies: ${a.started} started, ${a.superseded} superseded while waiting`,
+    hostLine(stats),
+  ];
+}
+
+/**
+ * Describes the native host's counters.
+ *
+ * @param {StatsSnapshot} stats
+ * @returns {string}
+ */
+function hostLine(stats) {
+  const h = stats.host;
+  if (!h) return `host: no stats, ${stats.hostError}`;
+  return (
+    `host: ${h.watcher} watcher, ${h.io} io, ${h.events} events, ` +
+    `${h.polls} polls, ${h.coalesced} coalesced, ${h.suppressed} suppressed, ` +
+    `${h.superseded} superseded, ${h.messages} messages, ` +
+    `${h.stalls} stalls, ${h.clients} clients`
+  );
+}
+
+/**
+ * Fetches the background page's counters and shows them.
+ *
+ * @returns {Promise<void>}
+ */
+async function refreshStats() {
+  const el = /** @type {HTMLElement} */ (document.getElementById("stats"));
+  try {
+    /** @type {StatsSnapshot} */
+    const stats = await browser.runtime.sendMessage({ type: "stats" });
+    el.replaceChildren(
+      ...statsLines(stats).flatMap((line, i) =>
+        i === 0 ? [line] : [document.createElement("br"), line],
+      ),
+    );
+  } catch (e) {
+    el.textContent = `could not read counters: ${e}`;
+  }
+}
+
+/**
+ * Fetches the background page's timings and redraws the page.
+ *
+ * @returns {Promise<void>}
+ */
+async function refresh() {
+  const summary = /** @type {HTMLElement} */ (
+    document.getElementById("summary")
+  );
+  const spans = /** @type {HTMLElement} */ (document.getElementById("spans"));
+  try {
+    /** @type {TraceSnapshot} */
+    const snapshot = await browser.runtime.sendMessage({ type: "perfTrace" });
+    summary.textContent =
+      `${snapshot.entries.length} of the last ${snapshot.capacity} ` +
+      `messages, ${snapshot.dropped} dropped as stale`;
+    spans.replaceChildren(
+      ...SPANS.map((name) =>
+        renderSpan(
+          name,
+          snapshot.entries
+            .map((e) => spanTime(e, name))
+            .filter((t) => t !== undefined),
+        ),
+      ),
+    );
+  } catch (e) {
+    summary.textContent = `could not read timings: ${e}`;
+  }
+}
+
+document.getElementById("refresh")?.addEventListener("click", () => {
+  void refresh();
+  void refreshStats();
+});
+
+void refresh();
+void refreshStats();
@@ -0,0 +1,161 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+import {
+  argbFromRgb,
+  Hct,
+  hexFromArgb,
+} from "@material/material-color-utilities";
+import { getAutogeneratedThemeColors } from "./autogenerated-theme-util";
+import {
+  argbToHSL,
+  getRelativeLuminance,
+  hSLToArgb,
+  isDark,
+} from "./color-utils";
+import { ALPHA_OPAQUE } from "./argb";
+import { MATERIAL_TONES } from "./material-scheme";
+
+/**
+ * @typedef {import("./create-firefox-theme").FirefoxTheme} FirefoxTheme
+ * @typedef {import("./color-utils").HSL} HSL
+ */
+
+/**
+ * A Material tonal palette stood in for by an HSL saturation: the primary
+ * palette is vivid whatever the seed, secondary muted, the neutrals close
+ * to grey. Fitted on p95 ΔE over random seeds and greys against the native
+ * host's port of createFirefoxTheme, not createFirefoxTheme itself; refit
+ * if scripts/verify-approximate-theme.js fails against the library.
+ * Containers and the neutrals' extreme tones take more HSL saturation for
+ * the same chroma.
+ */
+const PRIMARY_SATURATION = 0.6;
+const PRIMARY_CONTAINER_SATURATION = 0.85;
+const SECONDARY_SATURATION = 0.15;
+const NEUTRAL_SATURATION = 0.12;
+const NEUTRAL_VARIANT_SATURATION = 0.06;
+
+// bisection steps for a lightness; 2^-14 is well under one 8-bit step
+const LIGHTNESS_STEPS = 14;
+
+// chroma and tone of the color whose HSL hue stands in for the seed's HCT
+// hue: the primary palette's least chroma, at a tone where it is in gamut
+const HUE_CHROMA = 48;
+const HUE_TONE = 50;
+
+/**
+ * Relative luminance of a CIE L* tone.
+ *
+ * @param {number} tone  0..100
+ * @returns {number}
+ */
+function luminanceFromTone(tone) {
+  const f = (tone + 16) / 116;
+  return tone > 8 ? f * f * f : tone / 903.2962962;
+}
+
+/**
+ * The color of a hue and saturation whose luminance matches a tone.
+ *
+ * @param {number} hue  0..1
+ * @param {number} saturation  0..1
+ * @param {number} tone  0..100
+ * @returns {number}  Packed ARGB
+ */
+function colorAtTone(hue, saturation, tone) {
+  const target = luminanceFromTone(tone);
+  /** @type {HSL} */
+  const hsl = { h: hue, s: saturation, l: 0.5 };
+  let lo = 0;
+  let hi = 1;
+  for (let i = 0; i < LIGHTNESS_STEPS; i++) {
+    hsl.l = (lo + hi) / 2;
+    if (getRelativeLuminance(hSLToArgb(hsl, ALPHA_OPAQUE)) < target) {
+      lo = hsl.l;
+    } else {
+      hi = hsl.l;
+    }
+  }
+  hsl.l = (lo + hi) / 2;
+  return hSLToArgb(hsl, ALPHA_OPAQUE);
+}
+
+/**
+ * The HSL hue of the seed's Material palettes. CorePalette takes the hue from
+ * HCT, which even a grey has, so the seed's own HSL hue (0, red, for a grey)
+ * will not do; that of a color at the HCT hue is close enough.
+ *
+ * @param {number} argb  Seed color.
+ * @returns {number}  0..1
+ */
+function paletteHue(argb) {
+  const hue = Hct.fromInt(argb).hue;
+  return argbToHSL(Hct.from(hue, HUE_CHROMA, HUE_TONE).toInt()).h;
+}
+
+/**
+ * A cheap stand-in for createFirefoxTheme, to show while the exact theme is
+ * built. The Chromium-derived colors are exact; the Material roles take the
+ * HSL hue of the seed's HCT hue and match their tone's luminance instead of
+ * going through HCT palettes.
+ *
+ * @param {number} r - Red channel (0–255)
+ * @param {number} g - Green channel (0–255)
+ * @param {number} b - Blue channel (0–255)
+ * @returns {Readonly<FirefoxTheme>}
+ */
+export function createApproximateTheme(r, g, b) {
+  const argb = argbFromRgb(r, g, b);
+
+  const themeColors = getAutogeneratedThemeColors(argb);
+
+  const isDarkScheme = isDark(argb);
+  const tones = isDarkScheme ? MATERIAL_TONES.dark : MATERIAL_TONES.light;
+  const hue = paletteHue(argb);
+  const primary = colorAtTone(hue, PRIMARY_SATURATION, tones.primary);
+  const secondary = colorAtTone(hue, SECONDARY_SATURATION, tones.secondary);
+  const background = colorAtTone(hue, NEUTRAL_SATURATION, tones.background);
+
+  const popupBase = argbToHSL(background);
+  const popupTint = argbToHSL(primary);
+  const popupHSL = {
+    h: (popupBase.h * 5 + popupTint.h) / 6,
+    s: (popupBase.s * 5 + popupTint.s) / 6,
+    l: popupBase.l,
+  };
+
+  return Object.freeze({
+    colors: {
+      toolbar: hexFromArgb(themeColors.activeTabColor),
+      toolbar_text: hexFromArgb(themeColors.activeTabTextColor),
+      frame: hexFromArgb(themeColors.frameColor),
+      tab_background_text: hexFromArgb(secondary),
+      toolbar_field: hexFromArgb(
+        colorAtTone(hue, SECONDARY_SATURATION, tones.onSecondary),
+      ),
+      toolbar_field_text: hexFromArgb(themeColors.activeTabTextColor),
+      tab_line: hexFromArgb(primary),
+      popup: hexFromArgb(hSLToArgb(popupHSL, ALPHA_OPAQUE)),
+      popup_text: hexFromArgb(themeColors.activeTabTextColor),
+      button_background_hover: hexFromArgb(
+        colorAtTone(hue, PRIMARY_CONTAINER_SATURATION, tones.primaryContainer),
+      ),
+      icons: hexFromArgb(secondary),
+      toolbar_field_border_focus: hexFromArgb(primary),
+      toolbar_field_border: hexFromArgb(
+        colorAtTone(hue, NEUTRAL_VARIANT_SATURATION, tones.outline),
+      ),
+      toolbar_field_focus: hexFromArgb(themeColors.activeTabColor),
+      toolbar_field_highlight_text: hexFromArgb(background),
+      toolbar_field_highlight: hexFromArgb(primary),
+    },
+    properties: {
+      color_scheme: isDarkScheme ? "dark" : "light",
+    },
+  });
+}
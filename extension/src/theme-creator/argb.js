@@ -75,16 +75,32 @@ export function argbSetA(argb, a) {
   return packed;
 }
 
+/**
+ * Pack alpha, red, green and blue bytes into ARGB without validation.
+ * Callers pass values already clamped to 0..255. Like argbFromRgba the result
+ * is a signed int32, which V8 keeps unboxed.
+ *
+ * @param {number} a  Alpha byte
+ * @param {number} r  Red byte
+ * @param {number} g  Green byte
+ * @param {number} b  Blue byte
+ * @returns {number}  Packed ARGB (0xAARRGGBB) as a signed int32
+ */
+export function argbSetARGB(a, r, g, b) {
+  return ((a & 0xff) << 24) | (r << 16) | (g << 8) | b;
+}
+
 /**
  * Convert packed ARGB (0xAARRGGBB) into RGBA floats.
  *
  * @param {number} argb  Packed ARGB color
+ * @param {RgbaFloat} [out]  Object to write into instead of allocating
  * @returns {RgbaFloat}  Decomposed RGBA channels as floats
  */
-export function argbToRgbaFloat(argb) {
-  const a = ((argb >>> 24) & 0xff) * INV_255;
-  const r = ((argb >>> 16) & 0xff) * INV_255;
-  const g = ((argb >>> 8) & 0xff) * INV_255;
-  const b = (argb & 0xff) * INV_255;
-  return { r, g, b, a };
+export function argbToRgbaFloat(argb, out = { r: 0, g: 0, b: 0, a: 0 }) {
+  out.a = ((argb >>> 24) & 0xff) * INV_255;
+  out.r = ((argb >>> 16) & 0xff) * INV_255;
+  out.g = ((argb >>> 8) & 0xff) * INV_255;
+  out.b = (argb & 0xff) * INV_255;
+  return out;
 }
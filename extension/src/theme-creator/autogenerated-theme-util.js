@@ -15,6 +15,7 @@ import {
   getContrastRatioFloat,
   getContrastRatioArgb,
   getRelativeLuminance,
+  interpolatedLuminance,
   hSLToArgb,
   isDark,
   argbToHSL,
@@ -26,6 +27,18 @@ const kAutogeneratedThemeActiveTabPreferredContrast = 1.6;
 const kAutogeneratedThemeActiveTabPreferredContrastForDark = 1.7;
 const kAutogeneratedThemeTextPreferredContrast = 7.0;
 
+const kWhiteLuminance = 1.0;
+const kWhiteLuminance05 = kWhiteLuminance + 0.05;
+
+// Reused by the HSL helpers below so the solver loop does not allocate.
+// Each one is fully overwritten by argbToHSL before it is read.
+/** @type {import("./color-utils").HSL} */
+const darkenHsl = { h: 0, s: 0, l: 0 };
+/** @type {import("./color-utils").HSL} */
+const lightenHsl = { h: 0, s: 0, l: 0 };
+/** @type {import("./color-utils").HSL} */
+const frameHsl = { h: 0, s: 0, l: 0 };
+
 /**
  * @typedef {Object} AutogeneratedThemeColors
  * @property {number} frameColor         Packed ARGB for the frame background.
@@ -44,7 +57,7 @@ const kAutogeneratedThemeTextPreferredContrast = 7.0;
  * @returns {number}      New packed ARGB color.
  */
 function darkenColor(color, change) {
-  const hsl = argbToHSL(color);
+  const hsl = argbToHSL(color, darkenHsl);
   hsl.l -= change;
   if (hsl.l < 0.0) {
     return color;
@@ -59,6 +72,14 @@ function darkenColor(color, change) {
  *
  * Binary-searches lightness in [originalℓ, 1.0] to ~0.01 precision.
  *
+ * When every candidate is at least as light as `base` the test is monotone in
+ * lightness. The WCAG ratio is then inverted for the luminance needed, the
+ * bisection is replayed against the unrounded luminance of each step, and
+ * only the two steps it ends between are checked exactly. If both hold, every
+ * decision on the replayed path follows from them and the result is the one
+ * the full search returns; otherwise the failed step is recorded and the
+ * replay repeats.
+ *
  * @param {number} source          Packed ARGB to lighten.
  * @param {number} base            Packed ARGB to test contrast against.
  * @param {number} contrast_ratio  Target contrast ratio against `base`.
@@ -67,26 +88,160 @@ function darkenColor(color, change) {
  */
 function lightenUntilContrast(source, base, contrast_ratio, white_contrast) {
   const baseLuminance = getRelativeLuminance(base);
-  const kWhiteLuminance = 1.0;
 
-  const hsl = argbToHSL(source);
+  const hsl = argbToHSL(source, lightenHsl);
+  const startL = hsl.l;
+
+  const startLum =
+    source === base
+      ? baseLuminance
+      : getRelativeLuminance(hSLToArgb(hsl, 0xff));
+  if (startLum < baseLuminance) {
+    return bisectLightness(hsl, baseLuminance, contrast_ratio, white_contrast);
+  }
+
+  const neededLum = Math.min(
+    contrast_ratio * (baseLuminance + 0.05) - 0.05,
+    white_contrast > 0 ? kWhiteLuminance05 / white_contrast - 0.05 : Infinity,
+  );
+
+  const s = hsl.s;
+  const kR = hueWeight(hsl.h + 1.0 / 3.0);
+  const kG = hueWeight(hsl.h);
+  const kB = hueWeight(hsl.h - 1.0 / 3.0);
+
+  // lightness known to fail (≤ below) or pass (≥ above) the contrast test
+  let below = startL;
+  let above = 1.0;
+
+  for (;;) {
+    let minL = startL;
+    let maxL = 1.0;
+    while (maxL - minL > 0.01) {
+      const midL = minL + (maxL - minL) / 2;
+      const passed =
+        midL <= below
+          ? false
+          : midL >= above
+            ? true
+            : unroundedLuminance(midL, s, kR, kG, kB) >= neededLum;
+      if (passed) {
+        maxL = midL;
+      } else {
+        minL = midL;
+      }
+    }
+
+    if (maxL < above) {
+      if (
+        !meetsLightenContrast(
+          hsl,
+          maxL,
+          baseLuminance,
+          contrast_ratio,
+          white_contrast,
+        )
+      ) {
+        below = maxL;
+        continue;
+      }
+      above = maxL;
+    }
+
+    if (minL > below) {
+      if (
+        meetsLightenContrast(
+          hsl,
+          minL,
+          baseLuminance,
+          contrast_ratio,
+          white_contrast,
+        )
+      ) {
+        above = minL;
+        continue;
+      }
+      below = minL;
+    }
+
+    hsl.l = maxL;
+    return hSLToArgb(hsl, 0xff);
+  }
+}
+
+/**
+ * Luminance of HSL(h, s, l) before channels are rounded to bytes. For a fixed
+ * hue each channel is linear in l on either side of 0.5.
+ *
+ * @param {number} l
+ * @param {number} s
+ * @param {number} kR  hueWeight of the red channel
+ * @param {number} kG  hueWeight of the green channel
+ * @param {number} kB  hueWeight of the blue channel
+ * @returns {number}
+ */
+function unroundedLuminance(l, s, kR, kG, kB) {
+  if (l < 0.5) {
+    const scale = 255 * l;
+    return interpolatedLuminance(
+      scale * (1 - s + 2 * s * kR),
+      scale * (1 - s + 2 * s * kG),
+      scale * (1 - s + 2 * s * kB),
+    );
+  }
+  const scale = 255 * (1 - l);
+  return interpolatedLuminance(
+    255 - scale * (1 + s - 2 * s * kR),
+    255 - scale * (1 + s - 2 * s * kG),
+    255 - scale * (1 + s - 2 * s * kB),
+  );
+}
+
+/**
+ * Position of a channel between the HSL temp1 (0) and temp2 (1) values for a
+ * hue; the unrounded counterpart of calcHue in color-utils.
+ *
+ * @param {number} hue  Hue in 0..1 (may wrap)
+ * @returns {number}
+ */
+function hueWeight(hue) {
+  if (hue < 0.0) hue += 1.0;
+  else if (hue > 1.0) hue -= 1.0;
+
+  if (hue * 6.0 < 1.0) return hue * 6.0;
+  if (hue * 2.0 < 1.0) return 1.0;
+  if (hue * 3.0 < 2.0) return (2.0 / 3.0 - hue) * 6.0;
+  return 0.0;
+}
+
+/**
+ * Plain bisection for lightenUntilContrast, used when the test is not
+ * monotone in lightness.
+ *
+ * @param {import("./color-utils").HSL} hsl  Start color; l is overwritten.
+ * @param {number} baseLuminance
+ * @param {number} contrast_ratio
+ * @param {number} white_contrast
+ * @returns {number}
+ */
+function bisectLightness(hsl, baseLuminance, contrast_ratio, white_contrast) {
   let minL = hsl.l;
   let maxL = 1.0;
 
   while (maxL - minL > 0.01) {
-    hsl.l = minL + (maxL - minL) / 2;
-    const candidate = hSLToArgb(hsl, 0xff);
-    const candidateLum = getRelativeLuminance(candidate);
-
-    const meetsBaseContrast =
-      getContrastRatioFloat(baseLuminance, candidateLum) >= contrast_ratio;
-    const exceedsWhiteContrast =
-      getContrastRatioFloat(kWhiteLuminance, candidateLum) < white_contrast;
-
-    if (meetsBaseContrast || exceedsWhiteContrast) {
-      maxL = hsl.l;
+    const midL = minL + (maxL - minL) / 2;
+    if (
+      meetsLightenContrast(
+        hsl,
+        midL,
+        baseLuminance,
+        contrast_ratio,
+        white_contrast,
+      )
+    ) {
+      maxL = midL;
     } else {
-      minL = hsl.l;
+      minL = midL;
     }
   }
 
@@ -94,6 +249,34 @@ function lightenUntilContrast(source, base, contrast_ratio, white_contrast) {
   return hSLToArgb(hsl, 0xff);
 }
 
+/**
+ * The bisection test of lightenUntilContrast at lightness `l`.
+ *
+ * @param {import("./color-utils").HSL} hsl  Hue and saturation to use; l is overwritten.
+ * @param {number} l
+ * @param {number} baseLuminance
+ * @param {number} contrast_ratio
+ * @param {number} white_contrast
+ * @returns {boolean}
+ */
+function meetsLightenContrast(
+  hsl,
+  l,
+  baseLuminance,
+  contrast_ratio,
+  white_contrast,
+) {
+  hsl.l = l;
+  const candidateLum = getRelativeLuminance(hSLToArgb(hsl, 0xff));
+
+  const meetsBaseContrast =
+    getContrastRatioFloat(baseLuminance, candidateLum) >= contrast_ratio;
+  const exceedsWhiteContrast =
+    getContrastRatioFloat(kWhiteLuminance, candidateLum) < white_contrast;
+
+  return meetsBaseContrast || exceedsWhiteContrast;
+}
+
 /**
  * Generate theme colors that meet the contrast requirements for Firefox.
  *
@@ -129,9 +312,8 @@ export function getAutogeneratedThemeColors(argb) {
       kNoWhiteContrast,
     );
 
-    const frameHsl = argbToHSL(frameColor);
     const preferredContrast =
-      frameHsl.l <= kMaxLuminosityForDark
+      argbToHSL(frameColor, frameHsl).l <= kMaxLuminosityForDark
         ? kAutogeneratedThemeActiveTabPreferredContrastForDark
         : kAutogeneratedThemeActiveTabPreferredContrast;
 
@@ -12,7 +12,6 @@
 import {
   alphaFromArgb,
   argbFromRgb,
-  argbFromRgba,
   blueFromArgb,
   greenFromArgb,
   redFromArgb,
@@ -23,7 +22,7 @@ import {
   ARGB_TRANSPARENT,
   ARGB_WHITE,
   argbSetA,
-  argbToRgbaFloat,
+  argbSetARGB,
 } from "./argb";
 
 /**
@@ -70,6 +69,47 @@ function linearize(component) {
     : Math.pow((component + 0.055) / 1.055, 2.4);
 }
 
+/**
+ * linearize(i / 255) for every byte i, increasing in i. Relative luminance
+ * only ever linearizes 8-bit channels, so this replaces Math.pow with a load.
+ */
+const LINEAR_FROM_BYTE = new Float64Array(256);
+for (let i = 0; i < 256; i++) {
+  LINEAR_FROM_BYTE[i] = linearize(i * (1 / 255));
+}
+
+/**
+ * Linearizes an unrounded 0..255 channel by interpolating LINEAR_FROM_BYTE.
+ *
+ * @param {number} x  Channel value, clamped to 0..255
+ * @returns {number}
+ */
+function interpolateLinear(x) {
+  if (x <= 0) return 0.0;
+  if (x >= 255) return 1.0;
+  const i = Math.floor(x);
+  const lo = LINEAR_FROM_BYTE[i];
+  return lo + (LINEAR_FROM_BYTE[i + 1] - lo) * (x - i);
+}
+
+/**
+ * Approximate relative luminance of unrounded 0..255 channels. Monotone in
+ * each channel and within rounding of getRelativeLuminance; used to estimate
+ * where a search will end before checking it exactly.
+ *
+ * @param {number} r
+ * @param {number} g
+ * @param {number} b
+ * @returns {number}
+ */
+export function interpolatedLuminance(r, g, b) {
+  return (
+    0.2126 * interpolateLinear(r) +
+    0.7152 * interpolateLinear(g) +
+    0.0722 * interpolateLinear(b)
+  );
+}
+
 /**
  * Computes one RGB channel from hue cycle.
  *
@@ -98,9 +138,10 @@ function calcHue(temp1, temp2, hue) {
  * Converts packed ARGB to HSL.
  *
  * @param {number} c  Packed ARGB
+ * @param {HSL} [out]  Object to write into instead of allocating
  * @returns {HSL}
  */
-export function argbToHSL(c) {
+export function argbToHSL(c, out = { h: 0, s: 0, l: 0 }) {
   const r = redFromArgb(c) / 255.0;
   const g = greenFromArgb(c) / 255.0;
   const b = blueFromArgb(c) / 255.0;
@@ -132,7 +173,10 @@ export function argbToHSL(c) {
     s = delta / (l < 0.5 ? vmax + vmin : 2.0 - vmax - vmin);
   }
 
-  return { h, s, l };
+  out.h = h;
+  out.s = s;
+  out.l = l;
+  return out;
 }
 
 /**
@@ -149,7 +193,7 @@ export function hSLToArgb(hsl, alpha) {
 
   if (!saturation) {
     const light = clampRoundU8(lightness * 255);
-    return argbFromRgba({ r: light, g: light, b: light, a: alpha });
+    return argbSetARGB(alpha, light, light, light);
   }
 
   const temp2 =
@@ -158,12 +202,12 @@ export function hSLToArgb(hsl, alpha) {
       : lightness + saturation - lightness * saturation;
   const temp1 = 2.0 * lightness - temp2;
 
-  return argbFromRgba({
-    r: calcHue(temp1, temp2, hue + 1.0 / 3.0),
-    g: calcHue(temp1, temp2, hue),
-    b: calcHue(temp1, temp2, hue - 1.0 / 3.0),
-    a: alpha,
-  });
+  return argbSetARGB(
+    alpha,
+    calcHue(temp1, temp2, hue + 1.0 / 3.0),
+    calcHue(temp1, temp2, hue),
+    calcHue(temp1, temp2, hue - 1.0 / 3.0),
+  );
 }
 
 /**
@@ -173,14 +217,60 @@ export function hSLToArgb(hsl, alpha) {
  * @returns {number}  Luminance
  */
 export function getRelativeLuminance(argb) {
-  const rgba = argbToRgbaFloat(argb);
   return (
-    0.2126 * linearize(rgba.r) +
-    0.7152 * linearize(rgba.g) +
-    0.0722 * linearize(rgba.b)
+    0.2126 * LINEAR_FROM_BYTE[(argb >>> 16) & 0xff] +
+    0.7152 * LINEAR_FROM_BYTE[(argb >>> 8) & 0xff] +
+    0.0722 * LINEAR_FROM_BYTE[argb & 0xff]
   );
 }
 
+/**
+ * @typedef {Object} Oklab
+ * @property {number} l  Perceived lightness, 0.0–1.0
+ * @property {number} a  Green–red axis
+ * @property {number} b  Blue–yellow axis
+ */
+
+/**
+ * Converts an ARGB color to Oklab, ignoring alpha.
+ *
+ * Not part of color_utils.cc; see https://bottosson.github.io/posts/oklab/
+ *
+ * @param {number} argb
+ * @param {Oklab} [out]  Reused result object
+ * @returns {Oklab}
+ */
+export function argbToOklab(argb, out = { l: 0, a: 0, b: 0 }) {
+  const r = LINEAR_FROM_BYTE[(argb >>> 16) & 0xff];
+  const g = LINEAR_FROM_BYTE[(argb >>> 8) & 0xff];
+  const b = LINEAR_FROM_BYTE[argb & 0xff];
+  const l = Math.cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+  const m = Math.cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+  const s = Math.cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+  out.l = 0.2104542553 * l + 0.793617785 * m - 0.0040720468 * s;
+  out.a = 1.9779984951 * l - 2.428592205 * m + 0.4505937099 * s;
+  out.b = 0.0259040371 * l + 0.7827717662 * m - 0.808675766 * s;
+  return out;
+}
+
+const OKLAB_A = { l: 0, a: 0, b: 0 };
+const OKLAB_B = { l: 0, a: 0, b: 0 };
+
+/**
+ * Euclidean distance between two ARGB colors in Oklab. About 0.02 is just
+ * noticeable side by side.
+ *
+ * @param {number} colorA
+ * @param {number} colorB
+ * @returns {number}
+ */
+export function deltaEOklab(colorA, colorB) {
+  if (((colorA ^ colorB) & 0xffffff) === 0) return 0;
+  const x = argbToOklab(colorA, OKLAB_A);
+  const y = argbToOklab(colorB, OKLAB_B);
+  return Math.hypot(x.l - y.l, x.a - y.a, x.b - y.b);
+}
+
 /**
  * Returns true if color is darker than midpoint.
  *
@@ -270,12 +360,12 @@ function alphaBlendFloat(foreground, background, alpha) {
   const b =
     blueFromArgb(foreground) * f_weight + blueFromArgb(background) * b_weight;
 
-  return argbFromRgba({
-    r: clampRoundU8(r),
-    g: clampRoundU8(g),
-    b: clampRoundU8(b),
-    a: clampRoundU8(normalizer),
-  });
+  return argbSetARGB(
+    clampRoundU8(normalizer),
+    clampRoundU8(r),
+    clampRoundU8(g),
+    clampRoundU8(b),
+  );
 }
 
 /**
@@ -315,7 +405,13 @@ export function blendForMinContrast(
 
   default_foreground = getResultingPaintColor(default_foreground, background);
 
-  if (getContrastRatioArgb(default_foreground, background) >= contrast_ratio) {
+  const background_luminance = getRelativeLuminance(background);
+  const default_luminance = getRelativeLuminance(default_foreground);
+
+  if (
+    getContrastRatioFloat(default_luminance, background_luminance) >=
+    contrast_ratio
+  ) {
     return { alpha: ALPHA_TRANSPARENT, color: default_foreground };
   }
 
@@ -326,8 +422,117 @@ export function blendForMinContrast(
     background,
   );
 
-  const background_luminance = getRelativeLuminance(background);
+  const dr = redFromArgb(target_foreground) - redFromArgb(default_foreground);
+  const dg =
+    greenFromArgb(target_foreground) - greenFromArgb(default_foreground);
+  const db = blueFromArgb(target_foreground) - blueFromArgb(default_foreground);
+
+  // Contrast only grows with alpha when every channel moves the same way and
+  // the blend starts on the far side of the background; otherwise search.
+  const lighter = dr >= 0 && dg >= 0 && db >= 0;
+  const darker = dr <= 0 && dg <= 0 && db <= 0;
+  if (
+    !(lighter && default_luminance >= background_luminance) &&
+    !(darker && default_luminance <= background_luminance)
+  ) {
+    return bisectBlendAlpha(
+      default_foreground,
+      target_foreground,
+      background_luminance,
+      contrast_ratio,
+    );
+  }
+
+  // The bisection result is then the smallest alpha that meets the ratio.
+  // Invert the WCAG ratio for the luminance that takes, find the alpha where
+  // the unrounded blend reaches it, and step from there to the exact
+  // boundary.
+  const needed_luminance = lighter
+    ? contrast_ratio * (background_luminance + 0.05) - 0.05
+    : (background_luminance + 0.05) / contrast_ratio - 0.05;
+
+  const r0 = redFromArgb(default_foreground);
+  const g0 = greenFromArgb(default_foreground);
+  const b0 = blueFromArgb(default_foreground);
+
+  let low = ALPHA_TRANSPARENT;
+  let high = ALPHA_OPAQUE;
+  while (low < high) {
+    const mid = Math.floor((low + high) / 2);
+    const t = mid / 255.0;
+    const luminance = interpolatedLuminance(
+      r0 + dr * t,
+      g0 + dg * t,
+      b0 + db * t,
+    );
+    if (
+      lighter ? luminance >= needed_luminance : luminance <= needed_luminance
+    ) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+
+  let alpha = low;
+  let color = alphaBlendSkAlpha(target_foreground, default_foreground, alpha);
+  if (meetsContrast(color, background_luminance, contrast_ratio)) {
+    while (alpha > ALPHA_TRANSPARENT) {
+      const lower = alphaBlendSkAlpha(
+        target_foreground,
+        default_foreground,
+        alpha - 1,
+      );
+      if (!meetsContrast(lower, background_luminance, contrast_ratio)) break;
+      alpha--;
+      color = lower;
+    }
+    return { alpha, color };
+  }
+
+  while (alpha < ALPHA_OPAQUE) {
+    alpha++;
+    color = alphaBlendSkAlpha(target_foreground, default_foreground, alpha);
+    if (meetsContrast(color, background_luminance, contrast_ratio)) {
+      return { alpha, color };
+    }
+  }
 
+  return { alpha: ALPHA_OPAQUE, color: target_foreground };
+}
+
+/**
+ * Whether `color` reaches `contrast_ratio` against a background luminance.
+ *
+ * @param {number} color
+ * @param {number} background_luminance
+ * @param {number} contrast_ratio
+ * @returns {boolean}
+ */
+function meetsContrast(color, background_luminance, contrast_ratio) {
+  return (
+    getContrastRatioFloat(
+      getRelativeLuminance(color),
+      background_luminance,
+    ) >= contrast_ratio
+  );
+}
+
+/**
+ * Binary-searches the blend alpha; used when contrast is not monotone in alpha.
+ *
+ * @param {number} default_foreground
+ * @param {number} target_foreground
+ * @param {number} background_luminance
+ * @param {number} contrast_ratio
+ * @returns {BlendResult}
+ */
+function bisectBlendAlpha(
+  default_foreground,
+  target_foreground,
+  background_luminance,
+  contrast_ratio,
+) {
   let best_alpha = ALPHA_OPAQUE;
   let best_color = target_foreground;
 
@@ -337,10 +542,8 @@ export function blendForMinContrast(
   while (low < high) {
     const mid = Math.floor((low + high) / 2);
     const color = alphaBlendSkAlpha(target_foreground, default_foreground, mid);
-    const luminance = getRelativeLuminance(color);
-    const contrast = getContrastRatioFloat(luminance, background_luminance);
 
-    if (contrast >= contrast_ratio) {
+    if (meetsContrast(color, background_luminance, contrast_ratio)) {
       best_alpha = mid;
       best_color = color;
       high = mid;
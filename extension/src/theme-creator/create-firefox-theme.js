@@ -44,6 +44,13 @@ import { argbToHSL, hSLToArgb, isDark } from "./color-utils";
  * @property {FirefoxThemeProperties} properties
  */
 
+/**
+ * Bump whenever createFirefoxTheme (or the native host's port of it) can
+ * produce different colors for the same input, so cached themes built by an
+ * older version are discarded.
+ */
+export const THEME_ALGORITHM_VERSION = 2;
+
 /**
  * Generates a frozen Firefox theme object from an RGB base color.
  *
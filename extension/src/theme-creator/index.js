@@ -1 +1,3 @@
+export * from "./approximate-theme";
 export * from "./create-firefox-theme";
+export * from "./theme-distance";
@@ -0,0 +1,107 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+import { Hct, TonalPalette } from "@material/material-color-utilities";
+
+/**
+ * The Material roles createFirefoxTheme reads, as packed ARGB. Each equals
+ * the same role of `themeFromSourceColor(argb).schemes[light or dark]`.
+ *
+ * @typedef {Object} MaterialRoles
+ * @property {number} primary
+ * @property {number} primaryContainer
+ * @property {number} secondary
+ * @property {number} onSecondary
+ * @property {number} outline
+ * @property {number} background
+ */
+
+/**
+ * The tones Scheme.light and Scheme.dark take each role from.
+ */
+export const MATERIAL_TONES = Object.freeze({
+  dark: Object.freeze({
+    primary: 80,
+    primaryContainer: 30,
+    secondary: 80,
+    onSecondary: 20,
+    outline: 60,
+    background: 10,
+  }),
+  light: Object.freeze({
+    primary: 40,
+    primaryContainer: 90,
+    secondary: 40,
+    onSecondary: 100,
+    outline: 50,
+    background: 99,
+  }),
+});
+
+// chromas CorePalette.of gives the palettes used here; primary takes the
+// seed's chroma when that is higher
+const PRIMARY_MIN_CHROMA = 48;
+const SECONDARY_CHROMA = 16;
+const NEUTRAL_CHROMA = 4;
+const NEUTRAL_VARIANT_CHROMA = 8;
+
+// palettes kept; four per seed, so the last few seeds stay warm
+const PALETTE_CACHE_CAPACITY = 64;
+
+/**
+ * TonalPalette caches the tones it has solved, so keeping the palettes
+ * memoizes tones per hue and chroma. Least recently used first.
+ *
+ * @type {Map<string, TonalPalette>}
+ */
+const palettes = new Map();
+
+/**
+ * @param {number} hue
+ * @param {number} chroma
+ * @returns {TonalPalette}
+ */
+function tonalPalette(hue, chroma) {
+  const key = `${hue}/${chroma}`;
+  let palette = palettes.get(key);
+  if (palette) {
+    palettes.delete(key);
+  } else {
+    palette = TonalPalette.fromHueAndChroma(hue, chroma);
+    if (palettes.size >= PALETTE_CACHE_CAPACITY) {
+      palettes.delete(/** @type {string} */ (palettes.keys().next().value));
+    }
+  }
+  palettes.set(key, palette);
+  return palette;
+}
+
+/**
+ * Solves only the roles createFirefoxTheme needs, in one scheme, instead of
+ * both full schemes themeFromSourceColor builds.
+ *
+ * @param {number} argb  Seed color.
+ * @param {boolean} dark  Whether to take the dark scheme's tones.
+ * @returns {MaterialRoles}
+ */
+export function materialRoles(argb, dark) {
+  const hct = Hct.fromInt(argb);
+  const primary = tonalPalette(
+    hct.hue,
+    Math.max(PRIMARY_MIN_CHROMA, hct.chroma),
+  );
+  const secondary = tonalPalette(hct.hue, SECONDARY_CHROMA);
+  const tones = dark ? MATERIAL_TONES.dark : MATERIAL_TONES.light;
+  return {
+    primary: primary.tone(tones.primary),
+    primaryContainer: primary.tone(tones.primaryContainer),
+    secondary: secondary.tone(tones.secondary),
+    onSecondary: secondary.tone(tones.onSecondary),
+    outline: tonalPalette(hct.hue, NEUTRAL_VARIANT_CHROMA).tone(tones.outline),
+    background: tonalPalette(hct.hue, NEUTRAL_CHROMA).tone(tones.background),
+  };
+}
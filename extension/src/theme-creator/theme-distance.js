@@ -0,0 +1,49 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+import { deltaEOklab } from "./color-utils";
+
+/**
+ * @typedef {import("./create-firefox-theme").FirefoxTheme} FirefoxTheme
+ */
+
+/**
+ * Parses "#rrggbb" into opaque ARGB.
+ *
+ * @param {string} hex
+ * @returns {number}
+ */
+function argbFromHexColor(hex) {
+  return (0xff000000 | parseInt(hex.slice(1, 7), 16)) >>> 0;
+}
+
+/**
+ * How visibly two themes differ: the largest Oklab ΔE over their color
+ * slots, or Infinity when their color schemes or slots differ, since those
+ * always restyle.
+ *
+ * @param {Readonly<FirefoxTheme>} a
+ * @param {Readonly<FirefoxTheme>} b
+ * @returns {number}
+ */
+export function themeDistance(a, b) {
+  if (a.properties.color_scheme !== b.properties.color_scheme) {
+    return Infinity;
+  }
+  const keys = Object.keys(a.colors);
+  if (keys.length !== Object.keys(b.colors).length) return Infinity;
+
+  let max = 0;
+  for (const key of keys) {
+    const x = a.colors[/** @type {keyof typeof a.colors} */ (key)];
+    const y = b.colors[/** @type {keyof typeof b.colors} */ (key)];
+    if (x === y) continue;
+    if (typeof y !== "string") return Infinity;
+    max = Math.max(max, deltaEOklab(argbFromHexColor(x), argbFromHexColor(y)));
+  }
+  return max;
+}
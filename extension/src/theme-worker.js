@@ -0,0 +1,59 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+/**
+ * Dedicated worker that builds themes off the background page's event loop,
+ * see ThemeWorker for the protocol.
+ */
+
+import { createFirefoxTheme } from "./theme-creator";
+
+/**
+ * @typedef {import("./ThemeWorker").WorkerRequest} WorkerRequest
+ */
+
+/**
+ * The newest request not yet built. A request replaced before it runs is
+ * never built: the client has already given up on it.
+ *
+ * @type {{id: number, rgb: [number, number, number]}|null}
+ */
+let pending = null;
+
+let scheduled = false;
+
+/**
+ * Builds the pending theme, if any, and posts it back.
+ *
+ * @returns {void}
+ */
+function run() {
+  scheduled = false;
+  const req = pending;
+  pending = null;
+  if (!req) return;
+  try {
+    postMessage({ id: req.id, theme: createFirefoxTheme(...req.rgb) });
+  } catch (e) {
+    postMessage({ id: req.id, error: String(e) });
+  }
+}
+
+self.onmessage = (/** @type {MessageEvent<WorkerRequest>} */ e) => {
+  const msg = e.data;
+  if (msg.type === "create") {
+    pending = { id: msg.id, rgb: msg.rgb };
+    // building on a later task lets messages already queued behind this one
+    // replace or cancel it first
+    if (!scheduled) {
+      scheduled = true;
+      setTimeout(run, 0);
+    }
+  } else if (msg.type === "cancel" && pending?.id === msg.id) {
+    pending = null;
+  }
+};
@@ -0,0 +1,130 @@
+/**
+ * @license
+ * Copyright 2019 The Chromium Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Source: chromium/src/main/chrome/common/themes/autogenerated_theme_util.cc
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#include "autogenerated_theme.h"
+
+#define K_ACTIVE_TAB_MIN_CONTRAST 1.3
+#define K_ACTIVE_TAB_PREFERRED_CONTRAST 1.6
+#define K_ACTIVE_TAB_PREFERRED_CONTRAST_FOR_DARK 1.7
+#define K_TEXT_PREFERRED_CONTRAST 7.0
+
+#define K_DARKEN_STEP 0.03
+#define K_MIN_WHITE_CONTRAST 1.3
+#define K_NO_WHITE_CONTRAST 0.0
+#define K_MAX_LUMINOSITY_FOR_DARK 0.05
+
+// decrease lightness by `change` (0..1). returns original color if resulting
+// lightness would be < 0 to avoid producing invalid HSL.
+static argb_t darken_color(argb_t color, double change) {
+  hsl_t hsl = argb_to_hsl(color);
+  hsl.l -= change;
+  if (hsl.l < 0.0) {
+    return color;
+  }
+  return hsl_to_argb(hsl, 0xff);
+}
+
+// increase the lightness of `source` until one of:
+//   - contrast between `base` and candidate >= contrast_ratio, OR
+//   - contrast between white and candidate >= white_contrast
+// binary-searches lightness in [original l, 1.0] to ~0.01 precision.
+static argb_t lighten_until_contrast(argb_t source, argb_t base,
+                                     double contrast_ratio,
+                                     double white_contrast) {
+  const double base_luminance = get_relative_luminance(base);
+  const double k_white_luminance = 1.0;
+
+  hsl_t hsl = argb_to_hsl(source);
+  double min_l = hsl.l;
+  double max_l = 1.0;
+
+  while (max_l - min_l > 0.01) {
+    hsl.l = min_l + (max_l - min_l) / 2;
+    argb_t candidate = hsl_to_argb(hsl, 0xff);
+    double candidate_lum = get_relative_luminance(candidate);
+
+    int meets_base_contrast =
+        get_contrast_ratio_float(base_luminance, candidate_lum) >=
+        contrast_ratio;
+    int exceeds_white_contrast =
+        get_contrast_ratio_float(k_white_luminance, candidate_lum) <
+        white_contrast;
+
+    if (meets_base_contrast || exceeds_white_contrast) {
+      max_l = hsl.l;
+    } else {
+      min_l = hsl.l;
+    }
+  }
+
+  hsl.l = max_l;
+  return hsl_to_argb(hsl, 0xff);
+}
+
+autogenerated_theme_colors_t get_autogenerated_theme_colors(argb_t argb) {
+  argb_t frame_color = argb;
+  argb_t frame_text_color;
+  argb_t active_tab_color = argb;
+  argb_t active_tab_text_color;
+
+  while (1) {
+    frame_text_color = get_color_with_max_contrast(frame_color);
+
+    argb_t blend_target = get_color_with_max_contrast(frame_text_color);
+    frame_color =
+        blend_for_min_contrast(frame_color, frame_text_color, 1, blend_target,
+                               K_TEXT_PREFERRED_CONTRAST)
+            .color;
+
+    active_tab_color =
+        lighten_until_contrast(frame_color, frame_color,
+                               K_ACTIVE_TAB_MIN_CONTRAST, K_NO_WHITE_CONTRAST);
+
+    hsl_t frame_hsl = argb_to_hsl(frame_color);
+    double preferred_contrast = frame_hsl.l <= K_MAX_LUMINOSITY_FOR_DARK
+                                    ? K_ACTIVE_TAB_PREFERRED_CONTRAST_FOR_DARK
+                                    : K_ACTIVE_TAB_PREFERRED_CONTRAST;
+
+    active_tab_color =
+        lighten_until_contrast(active_tab_color, frame_color,
+                               preferred_contrast, K_MIN_WHITE_CONTRAST);
+
+    if (get_contrast_ratio_argb(frame_color, active_tab_color) <
+        K_ACTIVE_TAB_MIN_CONTRAST) {
+      frame_color = darken_color(frame_color, K_DARKEN_STEP);
+      continue;
+    }
+
+    active_tab_text_color = get_color_with_max_contrast(active_tab_color);
+
+    if (!is_dark(active_tab_color)) {
+      active_tab_color = lighten_until_contrast(
+          active_tab_color, active_tab_text_color, K_TEXT_PREFERRED_CONTRAST,
+          K_NO_WHITE_CONTRAST);
+      break;
+    }
+
+    if (get_contrast_ratio_argb(active_tab_color, ARGB_WHITE) >=
+        K_TEXT_PREFERRED_CONTRAST) {
+      break;
+    }
+
+    frame_color = darken_color(frame_color, K_DARKEN_STEP);
+  }
+
+  return (autogenerated_theme_colors_t){
+      .frame_color = frame_color,
+      .frame_text_color = frame_text_color,
+      .active_tab_color = active_tab_color,
+      .active_tab_text_color = active_tab_text_color,
+      .ntp_color = active_tab_color,
+  };
+}
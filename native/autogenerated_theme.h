@@ -0,0 +1,28 @@
+/**
+ * @license
+ * Copyright 2019 The Chromium Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Source: chromium/src/main/chrome/common/themes/autogenerated_theme_util.h
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#ifndef OMARCHY_AUTOGENERATED_THEME_H
+#define OMARCHY_AUTOGENERATED_THEME_H
+
+#include "color_utils.h"
+
+typedef struct {
+  argb_t frame_color;
+  argb_t frame_text_color;
+  argb_t active_tab_color;
+  argb_t active_tab_text_color;
+  argb_t ntp_color;
+} autogenerated_theme_colors_t;
+
+// generate theme colors that meet the contrast requirements for firefox
+autogenerated_theme_colors_t get_autogenerated_theme_colors(argb_t argb);
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _GNU_SOURCE
+
+#include "harness.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PATH_MAX_LEN 256
+
+static char home[] = "/tmp/omarchy-bench-XXXXXX";
+static char current_dir[PATH_MAX_LEN];
+
+static void die(const char *what) {
+  perror(what);
+  exit(1);
+}
+
+int64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void remove_home(void) {
+  char cmd[PATH_MAX_LEN + 16];
+  snprintf(cmd, sizeof(cmd), "rm -rf '%s'", home);
+  if (system(cmd) != 0) {
+    fprintf(stderr, "could not remove %s\n", home);
+  }
+}
+
+static void make_dir(const char *fmt, const char *a, int i) {
+  char path[PATH_MAX_LEN];
+  snprintf(path, sizeof(path), fmt, a, i);
+  if (mkdir(path, 0700) == -1) {
+    die(path);
+  }
+}
+
+void bench_theme_rgb(int i, int rgb[3]) {
+  rgb[0] = i % 256;
+  rgb[1] = (i / 256) % 256;
+  rgb[2] = 17;
+}
+
+void bench_make_home(int themes) {
+  if (mkdtemp(home) == NULL) {
+    die("mkdtemp");
+  }
+  atexit(remove_home);
+
+  make_dir("%s/.config", home, 0);
+  make_dir("%s/.config/omarchy", home, 0);
+  make_dir("%s/.config/omarchy/themes", home, 0);
+  make_dir("%s/.config/omarchy/current", home, 0);
+  snprintf(current_dir, sizeof(current_dir), "%s/.config/omarchy/current",
+           home);
+
+  for (int i = 0; i < themes; i++) {
+    make_dir("%s/.config/omarchy/themes/t%d", home, i);
+
+    char path[PATH_MAX_LEN];
+    snprintf(path, sizeof(path), "%s/.config/omarchy/themes/t%d/chromium.theme",
+             home, i);
+    FILE *f = fopen(path, "w");
+    int rgb[3];
+    bench_theme_rgb(i, rgb);
+    if (f == NULL || fprintf(f, "%d,%d,%d\n", rgb[0], rgb[1], rgb[2]) < 0 ||
+        fclose(f) != 0) {
+      die(path);
+    }
+  }
+  bench_switch_theme(0, SWITCH_RELINK);
+}
+
+const char *bench_home(void) { return home; }
+
+void bench_switch_theme(int i, bench_switch_t how) {
+  char target[PATH_MAX_LEN], link[PATH_MAX_LEN + 16], tmp[PATH_MAX_LEN + 16];
+  snprintf(target, sizeof(target), "../themes/t%d", i);
+  snprintf(link, sizeof(link), "%s/theme", current_dir);
+  snprintf(tmp, sizeof(tmp), "%s/.theme.tmp", current_dir);
+
+  if (how == SWITCH_RENAME) {
+    unlink(tmp);
+    if (symlink(target, tmp) == -1 || rename(tmp, link) == -1) {
+      die(link);
+    }
+    return;
+  }
+  if ((unlink(link) == -1 && errno != ENOENT) || symlink(target, link) == -1) {
+    die(link);
+  }
+}
+
+bench_switch_t bench_parse_switch(const char *s) {
+  if (strcmp(s, "rename") == 0) {
+    return SWITCH_RENAME;
+  }
+  if (strcmp(s, "relink") == 0) {
+    return SWITCH_RELINK;
+  }
+  fprintf(stderr, "expected rename or relink, got '%s'\n", s);
+  exit(2);
+}
+
+bench_host_t bench_start_host(const char *exe) {
+  int in[2], out[2];
+  if (pipe2(in, O_CLOEXEC) == -1 || pipe2(out, O_CLOEXEC) == -1) {
+    die("pipe2");
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    die("fork");
+  }
+  if (pid == 0) {
+    dup2(in[0], STDIN_FILENO);
+    dup2(out[1], STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDERR_FILENO);
+    setenv("HOME", home, 1);
+    execl(exe, exe, "--standalone", (char *)NULL);
+    _exit(127);
+  }
+
+  close(in[0]);
+  close(out[1]);
+  return (bench_host_t){.pid = pid, .in_fd = in[1], .out_fd = out[0]};
+}
+
+// read exactly len bytes, waiting at most until `deadline` (0: forever) for
+// the first of them. returns 0 or ETIMEDOUT.
+static int read_exact(int fd, void *buf, size_t len, int64_t deadline) {
+  char *p = buf;
+  while (len > 0) {
+    if (deadline != 0) {
+      int64_t left = (deadline - bench_now_ns()) / 1000000;
+      struct pollfd pfd = {.fd = fd, .events = POLLIN};
+      int r = poll(&pfd, 1, left > 0 ? (int)left : 0);
+      if (r == 0) {
+        return ETIMEDOUT;
+      }
+      if (r == -1 && errno == EINTR) {
+        continue;
+      }
+    }
+
+    ssize_t n = read(fd, p, len);
+    if (n <= 0) {
+      if (n == -1 && errno == EINTR) {
+        continue;
+      }
+      fprintf(stderr, "host closed stdout\n");
+      exit(1);
+    }
+    p += n;
+    len -= (size_t)n;
+    // the rest of a frame follows right away
+    deadline = 0;
+  }
+  return 0;
+}
+
+int bench_read_message(const bench_host_t *h, char *buf, int timeout_ms) {
+  int64_t deadline =
+      timeout_ms < 0 ? 0 : bench_now_ns() + (int64_t)timeout_ms * 1000000;
+  uint32_t len_le;
+  if (read_exact(h->out_fd, &len_le, sizeof(len_le), deadline) != 0) {
+    return ETIMEDOUT;
+  }
+  uint32_t len = le32toh(len_le);
+  if (len >= BENCH_MSG_MAX) {
+    fprintf(stderr, "message of %" PRIu32 " bytes\n", len);
+    exit(1);
+  }
+  read_exact(h->out_fd, buf, len, 0);
+  buf[len] = '\0';
+  return 0;
+}
+
+int bench_is_theme(const char *msg, const int rgb[3]) {
+  char want[32];
+  int n = snprintf(want, sizeof(want), "{\"rgb\":[%d,%d,%d]", rgb[0], rgb[1],
+                   rgb[2]);
+  return strncmp(msg, want, (size_t)n) == 0;
+}
+
+void bench_send_request(const bench_host_t *h, const char *json) {
+  uint32_t len = (uint32_t)strlen(json);
+  uint32_t len_le = htole32(len);
+  if (write(h->in_fd, &len_le, sizeof(len_le)) != sizeof(len_le) ||
+      write(h->in_fd, json, len) != (ssize_t)len) {
+    die("write request");
+  }
+}
+
+void bench_stats(const bench_host_t *h, char *buf) {
+  bench_send_request(h, "{\"type\":\"stats\"}");
+  do {
+    bench_read_message(h, buf, -1);
+  } while (strncmp(buf, "{\"type\":\"stats\"", 15) != 0);
+}
+
+// the text right after `"key":` in stats, or exit if there is none
+static const char *stat_value(const char *stats, const char *key) {
+  char member[64];
+  snprintf(member, sizeof(member), "\"%s\":", key);
+  const char *p = strstr(stats, member);
+  if (p == NULL) {
+    fprintf(stderr, "stats without '%s': %s\n", key, stats);
+    exit(1);
+  }
+  return p + strlen(member);
+}
+
+uint64_t bench_stat_u64(const char *stats, const char *key) {
+  return strtoull(stat_value(stats, key), NULL, 10);
+}
+
+void bench_stat_str(const char *stats, const char *key, char *dst,
+                    size_t size) {
+  const char *p = stat_value(stats, key);
+  size_t n = 0;
+  if (*p == '"') {
+    for (p++; p[n] != '\0' && p[n] != '"' && n + 1 < size; n++) {
+      dst[n] = p[n];
+    }
+  }
+  dst[n] = '\0';
+}
+
+void bench_stop_host(bench_host_t *h, struct rusage *usage) {
+  close(h->in_fd);
+  close(h->out_fd);
+  struct rusage ru;
+  while (wait4(h->pid, NULL, 0, &ru) == -1 && errno == EINTR) {
+  }
+  if (usage != NULL) {
+    *usage = ru;
+  }
+}
+
+static int compare_i64(const void *a, const void *b) {
+  int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+void bench_print_latency(const char *label, int64_t *ns, int n) {
+  if (n == 0) {
+    printf("%-16s %10s %10s %10s\n", label, "-", "-", "-");
+    return;
+  }
+  qsort(ns, (size_t)n, sizeof(*ns), compare_i64);
+  printf("%-16s %10.1f %10.1f %10.1f\n", label, (double)ns[n / 2] / 1000.0,
+         (double)ns[(int)((int64_t)n * 99 / 100)] / 1000.0,
+         (double)ns[n - 1] / 1000.0);
+}
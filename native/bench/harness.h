@@ -0,0 +1,83 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_BENCH_HARNESS_H
+#define OMARCHY_BENCH_HARNESS_H
+
+// Shared by the programs in native/bench: a throwaway HOME with an omarchy
+// tree, theme switches done the way omarchy does them, and a host started
+// with pipes on its stdio. Every helper exits the program on failure.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+
+#define BENCH_MSG_MAX 65536
+
+typedef struct {
+  pid_t pid;
+  int in_fd;  // the host's stdin
+  int out_fd; // the host's stdout
+} bench_host_t;
+
+// how bench_switch_theme points `current/theme` at another theme
+typedef enum {
+  // a new link renamed over `theme`, atomic like omarchy's theme switch
+  SWITCH_RENAME,
+  // `theme` unlinked and linked again, like `ln -sfn`
+  SWITCH_RELINK,
+} bench_switch_t;
+
+int64_t bench_now_ns(void);
+
+// create HOME with `themes` themes, each with a chromium.theme of its own
+// color (see bench_theme_rgb), and `current/theme` linked to theme 0. removed
+// again at exit.
+void bench_make_home(int themes);
+
+const char *bench_home(void);
+
+// the color theme `i` was created with
+void bench_theme_rgb(int i, int rgb[3]);
+
+// point `current/theme` at theme `i`
+void bench_switch_theme(int i, bench_switch_t how);
+
+// parse "rename" or "relink", exiting with usage help otherwise
+bench_switch_t bench_parse_switch(const char *s);
+
+// run `exe --standalone` with HOME set to bench_home and stderr on
+// /dev/null. the rest of the environment is passed through, so the host's
+// OMARCHY_FIREFOX_THEME_* variables apply.
+bench_host_t bench_start_host(const char *exe);
+
+// read one message into buf (BENCH_MSG_MAX). returns 0, or ETIMEDOUT if
+// none arrived within timeout_ms (-1 waits forever).
+int bench_read_message(const bench_host_t *h, char *buf, int timeout_ms);
+
+// whether `msg` is the theme message for rgb
+int bench_is_theme(const char *msg, const int rgb[3]);
+
+void bench_send_request(const bench_host_t *h, const char *json);
+
+// send a stats request and copy the reply into buf, skipping theme messages
+// that arrive first
+void bench_stats(const bench_host_t *h, char *buf);
+
+// a numeric or string member of a stats reply
+uint64_t bench_stat_u64(const char *stats, const char *key);
+void bench_stat_str(const char *stats, const char *key, char *dst,
+                    size_t size);
+
+// close the host's stdin, which ends it, and collect its resource usage
+void bench_stop_host(bench_host_t *h, struct rusage *usage);
+
+// sort `n` latencies and print p50, p99 and max in microseconds
+void bench_print_latency(const char *label, int64_t *ns, int n);
+
+#endif
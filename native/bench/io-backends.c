@@ -0,0 +1,362 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+// Compares the host's io backends (see io.h) on the path from a chromium.theme
+// change to the message on stdout: the latency from rewriting the file to
+// reading the new theme, the syscalls io.c made for the file read and the
+// stdout write, as counted by the host's own stats, and every syscall the
+// host process entered, epoll_wait and the inotify read included, as counted
+// by ptrace.
+//
+// Each backend runs a fresh `--standalone` host against a throwaway HOME with
+// a zero settle window, so every rewrite is one reload: once untraced for the
+// latency and io.c's count, then again under ptrace for the full count, since
+// tracing slows every syscall down.
+//
+// build: gcc -O2 -std=c11 -Wall -Wextra -o io-backends
+//          native/bench/io-backends.c
+// usage: ./io-backends path/to/omarchy-firefox-themehost [changes]
+
+#define _GNU_SOURCE
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_CHANGES 2000
+#define MSG_MAX 65536
+
+typedef struct {
+  pid_t pid;  // the host, or the process tracing it
+  int in_fd;  // the host's stdin
+  int out_fd; // the host's stdout
+} host_t;
+
+// syscalls entered by a traced host, counted by its tracer. shared, so the
+// bench reads it while the host runs.
+static atomic_uint_fast64_t *traced_syscalls;
+
+static char home[] = "/tmp/omarchy-io-bench-XXXXXX";
+static char theme_file[256];
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void die(const char *what) {
+  perror(what);
+  exit(1);
+}
+
+static void make_home(void) {
+  if (mkdtemp(home) == NULL) {
+    die("mkdtemp");
+  }
+  static const char *dirs[] = {"/.config", "/.config/omarchy",
+                               "/.config/omarchy/themes",
+                               "/.config/omarchy/themes/bench",
+                               "/.config/omarchy/current"};
+  char path[256];
+  for (size_t i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+    snprintf(path, sizeof(path), "%s%s", home, dirs[i]);
+    if (mkdir(path, 0700) == -1) {
+      die(path);
+    }
+  }
+  snprintf(path, sizeof(path), "%s/.config/omarchy/current/theme", home);
+  if (symlink("../themes/bench", path) == -1) {
+    die(path);
+  }
+  snprintf(theme_file, sizeof(theme_file),
+           "%s/.config/omarchy/themes/bench/chromium.theme", home);
+}
+
+static void remove_home(void) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "rm -rf '%s'", home);
+  if (system(cmd) != 0) {
+    fprintf(stderr, "could not remove %s\n", home);
+  }
+}
+
+// rewrite chromium.theme in place, which the host sees as IN_CLOSE_WRITE
+static void write_theme(int r, int g, int b) {
+  char line[32];
+  int len = snprintf(line, sizeof(line), "%d,%d,%d\n", r, g, b);
+  int fd = open(theme_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd == -1 || write(fd, line, (size_t)len) != len) {
+    die(theme_file);
+  }
+  close(fd);
+}
+
+static void read_exact(int fd, void *buf, size_t len) {
+  char *p = buf;
+  while (len > 0) {
+    ssize_t n = read(fd, p, len);
+    if (n <= 0) {
+      if (n == -1 && errno == EINTR) {
+        continue;
+      }
+      fprintf(stderr, "host closed stdout\n");
+      exit(1);
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+}
+
+// read one message from the host into buf (MSG_MAX)
+static void read_message(const host_t *h, char *buf) {
+  uint32_t len_le;
+  read_exact(h->out_fd, &len_le, sizeof(len_le));
+  uint32_t len = le32toh(len_le);
+  if (len >= MSG_MAX) {
+    fprintf(stderr, "message of %" PRIu32 " bytes\n", len);
+    exit(1);
+  }
+  read_exact(h->out_fd, buf, len);
+  buf[len] = '\0';
+}
+
+static void send_request(const host_t *h, const char *json) {
+  uint32_t len = (uint32_t)strlen(json);
+  uint32_t len_le = htole32(len);
+  if (write(h->in_fd, &len_le, sizeof(len_le)) != sizeof(len_le) ||
+      write(h->in_fd, json, len) != (ssize_t)len) {
+    die("write request");
+  }
+}
+
+// the host's io syscall count, from a stats request. theme messages that
+// arrive first are skipped.
+static uint64_t io_syscalls(const host_t *h, const char **backend) {
+  static char buf[MSG_MAX];
+  static char name[16];
+  send_request(h, "{\"type\":\"stats\"}");
+  do {
+    read_message(h, buf);
+  } while (strncmp(buf, "{\"type\":\"stats\"", 15) != 0);
+
+  const char *io = strstr(buf, "\"io\":\"");
+  const char *n = strstr(buf, "\"ioSyscalls\":");
+  if (io == NULL || n == NULL) {
+    fprintf(stderr, "stats without io counters: %s\n", buf);
+    exit(1);
+  }
+  sscanf(io + 6, "%15[^\"]", name);
+  *backend = name;
+  return strtoull(n + 13, NULL, 10);
+}
+
+// trace `pid`, stopped at its exec, counting every syscall any of its threads
+// enters into *traced_syscalls until it exits
+static void trace_host(pid_t pid) {
+  int status;
+  if (waitpid(pid, &status, 0) == -1 || !WIFSTOPPED(status) ||
+      ptrace(PTRACE_SETOPTIONS, pid, 0,
+             PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE |
+                 PTRACE_O_EXITKILL) == -1) {
+    die("ptrace");
+  }
+
+  pid_t tid = pid; // the thread to resume, or 0 if none is stopped
+  int sig = 0;     // the signal to deliver as it resumes
+  for (;;) {
+    if (tid != 0 && ptrace(PTRACE_SYSCALL, tid, 0, sig) == -1 &&
+        errno != ESRCH) {
+      die("PTRACE_SYSCALL");
+    }
+    sig = 0;
+    tid = waitpid(-1, &status, __WALL);
+    if (tid == -1) {
+      if (errno != EINTR) {
+        die("waitpid");
+      }
+      tid = 0;
+      continue;
+    }
+    if (WIFEXITED(status) || WIFSIGNALED(status)) {
+      if (tid == pid) {
+        return;
+      }
+      tid = 0;
+      continue;
+    }
+
+    if (WSTOPSIG(status) == (SIGTRAP | 0x80)) {
+      struct __ptrace_syscall_info info;
+      if (ptrace(PTRACE_GET_SYSCALL_INFO, tid, sizeof(info), &info) > 0 &&
+          info.op == PTRACE_SYSCALL_INFO_ENTRY) {
+        atomic_fetch_add_explicit(traced_syscalls, 1, memory_order_relaxed);
+      }
+    } else if (status >> 16 == 0 && WSTOPSIG(status) != SIGSTOP &&
+               WSTOPSIG(status) != SIGTRAP) {
+      // a signal for the host, not a ptrace event or a new thread's stop
+      sig = WSTOPSIG(status);
+    }
+  }
+}
+
+// start a host, traced if `traced`: then host_t.pid is a tracer between the
+// bench and the host, which exits with it
+static host_t start_host(const char *exe, const char *backend, int traced) {
+  int in[2], out[2];
+  if (pipe2(in, O_CLOEXEC) == -1 || pipe2(out, O_CLOEXEC) == -1) {
+    die("pipe2");
+  }
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    die("fork");
+  }
+  if (pid == 0) {
+    dup2(in[0], STDIN_FILENO);
+    dup2(out[1], STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDERR_FILENO);
+    setenv("HOME", home, 1);
+    setenv("OMARCHY_FIREFOX_THEME_IO", backend, 1);
+    setenv("OMARCHY_FIREFOX_THEME_SETTLE_MS", "0", 1);
+    if (traced) {
+      pid_t host = fork();
+      if (host == -1) {
+        die("fork");
+      }
+      if (host != 0) {
+        // only the host may hold its pipes, so it sees them close. the
+        // tracer never execs, so O_CLOEXEC does not close them here.
+        close(STDIN_FILENO);
+        close(STDOUT_FILENO);
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        trace_host(host);
+        _exit(0);
+      }
+      ptrace(PTRACE_TRACEME, 0, 0, 0);
+    }
+    execl(exe, exe, "--standalone", (char *)NULL);
+    _exit(127);
+  }
+
+  close(in[0]);
+  close(out[1]);
+  return (host_t){.pid = pid, .in_fd = in[1], .out_fd = out[0]};
+}
+
+static void stop_host(host_t *h) {
+  close(h->in_fd);
+  close(h->out_fd);
+  while (waitpid(h->pid, NULL, 0) == -1 && errno == EINTR) {
+  }
+}
+
+static int compare_i64(const void *a, const void *b) {
+  int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// rewrite chromium.theme `changes` times, each time waiting for the host's
+// message, and note each latency into `lat` unless it is NULL
+static void drive(const host_t *h, int changes, int64_t *lat) {
+  static char buf[MSG_MAX];
+  for (int i = 0; i < changes; i++) {
+    // every color differs from the last, so nothing is suppressed
+    int r = i % 256, g = (i / 256) % 256, b = 2 + i % 2;
+    char want[32];
+    snprintf(want, sizeof(want), "{\"rgb\":[%d,%d,%d]", r, g, b);
+
+    int64_t t0 = now_ns();
+    write_theme(r, g, b);
+    do {
+      read_message(h, buf);
+    } while (strncmp(buf, want, strlen(want)) != 0);
+    if (lat != NULL) {
+      lat[i] = now_ns() - t0;
+    }
+  }
+}
+
+static void run(const char *exe, const char *backend, int changes) {
+  static char buf[MSG_MAX];
+  int64_t *lat = calloc((size_t)changes, sizeof(*lat));
+  if (lat == NULL) {
+    die("calloc");
+  }
+
+  write_theme(0, 0, 1);
+  host_t h = start_host(exe, backend, 0);
+  read_message(&h, buf);
+  const char *actual;
+  uint64_t before = io_syscalls(&h, &actual);
+  drive(&h, changes, lat);
+  uint64_t after = io_syscalls(&h, &actual);
+  stop_host(&h);
+
+  write_theme(0, 0, 1);
+  h = start_host(exe, backend, 1);
+  read_message(&h, buf);
+  uint64_t traced_before = atomic_load(traced_syscalls);
+  drive(&h, changes, NULL);
+  uint64_t traced_after = atomic_load(traced_syscalls);
+  stop_host(&h);
+
+  qsort(lat, (size_t)changes, sizeof(*lat), compare_i64);
+  printf("%-8s %-8s %10.1f %10.1f %10.1f %14.2f %14.2f\n", backend, actual,
+         (double)lat[changes / 2] / 1000.0,
+         (double)lat[(changes * 99) / 100] / 1000.0,
+         (double)lat[changes - 1] / 1000.0,
+         (double)(after - before) / changes,
+         (double)(traced_after - traced_before) / changes);
+  free(lat);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s HOST [changes]\n", argv[0]);
+    return 2;
+  }
+  int changes = argc > 2 ? atoi(argv[2]) : DEFAULT_CHANGES;
+  if (changes < 1) {
+    changes = DEFAULT_CHANGES;
+  }
+
+  traced_syscalls = mmap(NULL, sizeof(*traced_syscalls),
+                         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                         -1, 0);
+  if (traced_syscalls == MAP_FAILED) {
+    die("mmap");
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  make_home();
+  printf("%d changes per backend, latency in us, syscalls per change\n",
+         changes);
+  printf("%-8s %-8s %10s %10s %10s %14s %14s\n", "asked", "ran", "p50", "p99",
+         "max", "io.c", "whole host");
+  run(argv[1], "sync", changes);
+  run(argv[1], "uring", changes);
+  remove_home();
+  return 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+// Measures the host end to end: from switching themes the way omarchy does,
+// by renaming a new `current/theme` link over the old one, to reading the
+// new theme's message on the host's stdout.
+//
+// A `--standalone` host runs against a throwaway HOME and the themes are
+// switched one at a time, each switch waiting for its message, so the
+// numbers include the settle window. The host's environment is passed
+// through: OMARCHY_FIREFOX_THEME_SETTLE_MS=0 leaves only the host's own
+// work, and OMARCHY_FIREFOX_THEME_WATCH and _IO pick its backends.
+//
+// build: gcc -O2 -std=c11 -Wall -Wextra -o latency
+//          native/bench/latency.c native/bench/harness.c
+// usage: ./latency path/to/omarchy-firefox-themehost [switches] [rename|relink]
+
+#define _GNU_SOURCE
+
+#include "harness.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_SWITCHES 2000
+#define THEMES 16
+// a switch without its message by then is counted as missed
+#define TIMEOUT_MS 5000
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s HOST [switches] [rename|relink]\n", argv[0]);
+    return 2;
+  }
+  int switches = argc > 2 ? atoi(argv[2]) : DEFAULT_SWITCHES;
+  if (switches < 1) {
+    switches = DEFAULT_SWITCHES;
+  }
+  bench_switch_t how = argc > 3 ? bench_parse_switch(argv[3]) : SWITCH_RENAME;
+
+  static char buf[BENCH_MSG_MAX];
+  int64_t *lat = calloc((size_t)switches, sizeof(*lat));
+  if (lat == NULL) {
+    perror("calloc");
+    return 1;
+  }
+
+  bench_make_home(THEMES);
+  bench_host_t h = bench_start_host(argv[1]);
+  int rgb[3];
+  bench_theme_rgb(0, rgb);
+  do {
+    if (bench_read_message(&h, buf, TIMEOUT_MS) != 0) {
+      fprintf(stderr, "no first theme from the host\n");
+      return 1;
+    }
+  } while (!bench_is_theme(buf, rgb));
+
+  int measured = 0, missed = 0;
+  for (int i = 1; i <= switches; i++) {
+    // never the theme already current, so no switch is suppressed
+    int theme = i % THEMES;
+    bench_theme_rgb(theme, rgb);
+
+    int64_t t0 = bench_now_ns();
+    bench_switch_theme(theme, how);
+    int err;
+    do {
+      err = bench_read_message(&h, buf, TIMEOUT_MS);
+    } while (err == 0 && !bench_is_theme(buf, rgb));
+    if (err == ETIMEDOUT) {
+      missed++;
+      continue;
+    }
+    lat[measured++] = bench_now_ns() - t0;
+  }
+
+  char watcher[16], io[16];
+  bench_stats(&h, buf);
+  bench_stat_str(buf, "watcher", watcher, sizeof(watcher));
+  bench_stat_str(buf, "io", io, sizeof(io));
+  bench_stop_host(&h, NULL);
+
+  printf("%d switches by %s, %s watcher, %s io, %d missed, latency in us\n",
+         switches, how == SWITCH_RENAME ? "rename" : "relink", watcher, io,
+         missed);
+  printf("%-16s %10s %10s %10s\n", "", "p50", "p99", "max");
+  bench_print_latency("switch->message", lat, measured);
+  free(lat);
+  return missed == 0 ? 0 : 1;
+}
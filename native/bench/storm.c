@@ -0,0 +1,180 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+// Switches themes far faster than anyone would by hand, the way preview and
+// slideshow scripts do, to see what the host does with a storm of `theme`
+// renames: how many messages it sends, what CPU time and memory it takes,
+// and whether its last message is the last theme switched to.
+//
+// Switches come in bursts of `burst` back to back, with bursts spaced so
+// that `rate` switches happen per second on average; `rate` 0 switches
+// without pausing. The host's messages are read throughout, so stdout never
+// backs up. Once the storm ends the host gets QUIET_MS to send its last
+// message.
+//
+// build: gcc -O2 -std=c11 -Wall -Wextra -o storm
+//          native/bench/storm.c native/bench/harness.c
+// usage: ./storm HOST [rate] [burst] [seconds] [rename|relink]
+//   e.g. ./storm HOST 5000 1 5     steady 5000 switches/s
+//        ./storm HOST 2000 200 5   200 switches every 100ms
+
+#define _GNU_SOURCE
+
+#include "harness.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define THEMES 16
+// without a message for this long after the storm, the host is done. covers
+// the poll watcher's longest interval.
+#define QUIET_MS 2500
+
+static int messages;
+static int last_theme = -1; // index of the theme in the last message, or -1
+static char buf[BENCH_MSG_MAX];
+
+static void note_message(void) {
+  if (strncmp(buf, "{\"type\":", 8) == 0) {
+    return;
+  }
+  messages++;
+  last_theme = -1;
+  for (int i = 0; i < THEMES; i++) {
+    int rgb[3];
+    bench_theme_rgb(i, rgb);
+    if (bench_is_theme(buf, rgb)) {
+      last_theme = i;
+      break;
+    }
+  }
+}
+
+// read messages until `deadline`, which is in bench_now_ns time
+static void drain_until(const bench_host_t *h, int64_t deadline) {
+  for (;;) {
+    int64_t left = deadline - bench_now_ns();
+    if (left < 0) {
+      left = 0;
+    }
+    struct timespec ts = {.tv_sec = left / 1000000000,
+                          .tv_nsec = left % 1000000000};
+    struct pollfd pfd = {.fd = h->out_fd, .events = POLLIN};
+    if (ppoll(&pfd, 1, &ts, NULL) <= 0) {
+      if (left == 0 || bench_now_ns() >= deadline) {
+        return;
+      }
+      continue;
+    }
+    bench_read_message(h, buf, -1);
+    note_message();
+  }
+}
+
+// read messages until none arrives for QUIET_MS
+static void drain_quiet(const bench_host_t *h) {
+  while (bench_read_message(h, buf, QUIET_MS) == 0) {
+    note_message();
+  }
+}
+
+// the host's resident set in KiB, from /proc, or -1
+static long rss_kib(pid_t pid) {
+  char path[64], line[128];
+  snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return -1;
+  }
+  long kib = -1;
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (sscanf(line, "VmRSS: %ld", &kib) == 1) {
+      break;
+    }
+  }
+  fclose(f);
+  return kib;
+}
+
+static double seconds(struct timeval tv) {
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "usage: %s HOST [rate] [burst] [seconds] [rename|relink]\n",
+            argv[0]);
+    return 2;
+  }
+  double rate = argc > 2 ? atof(argv[2]) : 1000;
+  int burst = argc > 3 ? atoi(argv[3]) : 1;
+  double duration = argc > 4 ? atof(argv[4]) : 5;
+  bench_switch_t how = argc > 5 ? bench_parse_switch(argv[5]) : SWITCH_RENAME;
+  if (rate < 0 || burst < 1 || duration <= 0) {
+    fprintf(stderr, "rate must be >= 0, burst >= 1 and seconds > 0\n");
+    return 2;
+  }
+
+  bench_make_home(THEMES);
+  bench_host_t h = bench_start_host(argv[1]);
+  if (bench_read_message(&h, buf, QUIET_MS) != 0) {
+    fprintf(stderr, "no first theme from the host\n");
+    return 1;
+  }
+  note_message();
+  long rss_before = rss_kib(h.pid);
+
+  int64_t gap = rate > 0 ? (int64_t)(1e9 * burst / rate) : 0;
+  int64_t start = bench_now_ns();
+  int64_t end = start + (int64_t)(duration * 1e9);
+  int64_t next = start;
+  int switches = 0, theme = 0;
+  while (bench_now_ns() < end) {
+    for (int i = 0; i < burst; i++) {
+      theme = (theme + 1) % THEMES;
+      bench_switch_theme(theme, how);
+      switches++;
+    }
+    // with no gap this only reads what has already arrived
+    next = gap > 0 ? next + gap : bench_now_ns();
+    drain_until(&h, next < end ? next : end);
+  }
+  double storm_s = (double)(bench_now_ns() - start) / 1e9;
+  drain_quiet(&h);
+
+  long rss_after = rss_kib(h.pid);
+  bench_stats(&h, buf);
+  uint64_t events = bench_stat_u64(buf, "events");
+  uint64_t coalesced = bench_stat_u64(buf, "coalesced");
+  uint64_t overflows = bench_stat_u64(buf, "overflows");
+  char watcher[16];
+  bench_stat_str(buf, "watcher", watcher, sizeof(watcher));
+  struct rusage ru;
+  bench_stop_host(&h, &ru);
+
+  double cpu = seconds(ru.ru_utime) + seconds(ru.ru_stime);
+  int correct = last_theme == theme;
+  printf("%d switches by %s in %.2fs (%.0f/s, bursts of %d), %s watcher\n",
+         switches, how == SWITCH_RENAME ? "rename" : "relink", storm_s,
+         switches / storm_s, burst, watcher);
+  printf("messages  %d (%.4f per switch)\n", messages,
+         (double)messages / switches);
+  printf("events    %llu read, %llu coalesced, %llu overflows\n",
+         (unsigned long long)events, (unsigned long long)coalesced,
+         (unsigned long long)overflows);
+  printf("cpu       %.3fs user, %.3fs sys, %.2fus per switch\n",
+         seconds(ru.ru_utime), seconds(ru.ru_stime), cpu * 1e6 / switches);
+  printf("rss       %ld KiB before, %ld KiB after, %ld KiB peak\n", rss_before,
+         rss_after, ru.ru_maxrss);
+  printf("final     %s (last message theme %d, last switch theme %d)\n",
+         correct ? "ok" : "WRONG", last_theme, theme);
+  return correct ? 0 : 1;
+}
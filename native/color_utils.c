@@ -0,0 +1,233 @@
+/**
+ * @license
+ * Copyright 2012 The Chromium Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Source: chromium/src/main/ui/gfx/color_utils.cc
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#include "color_utils.h"
+
+#include <math.h>
+
+// darkest reference color
+#define G_DARKEST_COLOR 0xff202124u
+// luminance midpoint for deciding light/dark
+#define G_LUMINANCE_MIDPOINT 0.211692036
+
+// round half up like javascript's Math.round, then clamp to 0..255
+static uint8_t clamp_round_u8(double n) {
+  double r = floor(n);
+  if (n - r >= 0.5)
+    r += 1.0;
+  if (r > 255.0)
+    return 0xff;
+  if (r < 0.0)
+    return 0x00;
+  return (uint8_t)r;
+}
+
+static argb_t argb_from_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+  return ((argb_t)a << 24) | ((argb_t)r << 16) | ((argb_t)g << 8) | (argb_t)b;
+}
+
+// sRGB linearization (assumes component in 0..1)
+static double linearize(double component) {
+  return component <= 0.04045 ? component / 12.92
+                              : pow((component + 0.055) / 1.055, 2.4);
+}
+
+// computes one RGB channel from hue cycle
+static uint8_t calc_hue(double temp1, double temp2, double hue) {
+  if (hue < 0.0)
+    hue += 1.0;
+  else if (hue > 1.0)
+    hue -= 1.0;
+
+  double result = temp1;
+  if (hue * 6.0 < 1.0) {
+    result = temp1 + (temp2 - temp1) * hue * 6.0;
+  } else if (hue * 2.0 < 1.0) {
+    result = temp2;
+  } else if (hue * 3.0 < 2.0) {
+    result = temp1 + (temp2 - temp1) * (2.0 / 3.0 - hue) * 6.0;
+  }
+
+  return clamp_round_u8(result * 255);
+}
+
+void hex_from_argb(argb_t c, char dst[8]) {
+  static const char hex[] = "0123456789abcdef";
+  uint8_t ch[3] = {red_from_argb(c), green_from_argb(c), blue_from_argb(c)};
+
+  dst[0] = '#';
+  for (int i = 0; i < 3; i++) {
+    dst[1 + i * 2] = hex[ch[i] >> 4];
+    dst[2 + i * 2] = hex[ch[i] & 0xf];
+  }
+  dst[7] = '\0';
+}
+
+hsl_t argb_to_hsl(argb_t c) {
+  double r = red_from_argb(c) / 255.0;
+  double g = green_from_argb(c) / 255.0;
+  double b = blue_from_argb(c) / 255.0;
+
+  double vmin = fmin(r, fmin(g, b));
+  double vmax = fmax(r, fmax(g, b));
+  double delta = vmax - vmin;
+
+  hsl_t hsl = {0.0, 0.0, (vmin + vmax) / 2.0};
+
+  if (delta != 0) {
+    double dr = ((vmax - r) / 6.0 + delta / 2.0) / delta;
+    double dg = ((vmax - g) / 6.0 + delta / 2.0) / delta;
+    double db = ((vmax - b) / 6.0 + delta / 2.0) / delta;
+
+    if (r >= g && r >= b) {
+      hsl.h = db - dg;
+    } else if (g >= r && g >= b) {
+      hsl.h = 1.0 / 3.0 + dr - db;
+    } else {
+      hsl.h = 2.0 / 3.0 + dg - dr;
+    }
+
+    if (hsl.h < 0.0)
+      hsl.h += 1.0;
+    else if (hsl.h > 1.0)
+      hsl.h -= 1.0;
+
+    hsl.s = delta / (hsl.l < 0.5 ? vmax + vmin : 2.0 - vmax - vmin);
+  }
+
+  return hsl;
+}
+
+argb_t hsl_to_argb(hsl_t hsl, uint8_t alpha) {
+  if (!hsl.s) {
+    uint8_t light = clamp_round_u8(hsl.l * 255);
+    return argb_from_rgba(light, light, light, alpha);
+  }
+
+  double temp2 = hsl.l < 0.5 ? hsl.l * (1.0 + hsl.s)
+                             : hsl.l + hsl.s - hsl.l * hsl.s;
+  double temp1 = 2.0 * hsl.l - temp2;
+
+  return argb_from_rgba(calc_hue(temp1, temp2, hsl.h + 1.0 / 3.0),
+                        calc_hue(temp1, temp2, hsl.h),
+                        calc_hue(temp1, temp2, hsl.h - 1.0 / 3.0), alpha);
+}
+
+double get_relative_luminance(argb_t c) {
+  return 0.2126 * linearize(red_from_argb(c) * (1 / 255.0)) +
+         0.7152 * linearize(green_from_argb(c) * (1 / 255.0)) +
+         0.0722 * linearize(blue_from_argb(c) * (1 / 255.0));
+}
+
+int is_dark(argb_t c) {
+  return get_relative_luminance(c) < G_LUMINANCE_MIDPOINT;
+}
+
+argb_t get_color_with_max_contrast(argb_t c) {
+  return is_dark(c) ? ARGB_WHITE : G_DARKEST_COLOR;
+}
+
+double get_contrast_ratio_argb(argb_t a, argb_t b) {
+  return get_contrast_ratio_float(get_relative_luminance(a),
+                                  get_relative_luminance(b));
+}
+
+double get_contrast_ratio_float(double luminance_a, double luminance_b) {
+  double a = luminance_a + 0.05;
+  double b = luminance_b + 0.05;
+  return a > b ? a / b : b / a;
+}
+
+// alpha blend with float alpha multiplier
+static argb_t alpha_blend_float(argb_t foreground, argb_t background,
+                                double alpha) {
+  if (alpha <= 0.0)
+    return background;
+  if (alpha >= 1.0)
+    return foreground;
+
+  double f_a = alpha_from_argb(foreground);
+  double b_a = alpha_from_argb(background);
+
+  double normalizer = f_a * alpha + b_a * (1.0 - alpha);
+  if (normalizer == 0.0)
+    return ARGB_TRANSPARENT;
+
+  double f_weight = (f_a * alpha) / normalizer;
+  double b_weight = (b_a * (1.0 - alpha)) / normalizer;
+
+  double r = red_from_argb(foreground) * f_weight +
+             red_from_argb(background) * b_weight;
+  double g = green_from_argb(foreground) * f_weight +
+             green_from_argb(background) * b_weight;
+  double b = blue_from_argb(foreground) * f_weight +
+             blue_from_argb(background) * b_weight;
+
+  return argb_from_rgba(clamp_round_u8(r), clamp_round_u8(g),
+                        clamp_round_u8(b), clamp_round_u8(normalizer));
+}
+
+// alpha blend in 0..255 domain
+static argb_t alpha_blend_sk_alpha(argb_t foreground, argb_t background,
+                                   uint32_t alpha) {
+  return alpha_blend_float(foreground, background, alpha / 255.0);
+}
+
+// treats foreground as fully opaque, then alpha-blends over background
+static argb_t get_resulting_paint_color(argb_t foreground,
+                                        argb_t background) {
+  return alpha_blend_sk_alpha(argb_set_a(foreground, ALPHA_OPAQUE), background,
+                              alpha_from_argb(foreground));
+}
+
+blend_result_t blend_for_min_contrast(argb_t default_foreground,
+                                      argb_t background,
+                                      int has_high_contrast_foreground,
+                                      argb_t high_contrast_foreground,
+                                      double contrast_ratio) {
+  default_foreground =
+      get_resulting_paint_color(default_foreground, background);
+
+  if (get_contrast_ratio_argb(default_foreground, background) >=
+      contrast_ratio) {
+    return (blend_result_t){ALPHA_TRANSPARENT, default_foreground};
+  }
+
+  argb_t target_foreground = get_resulting_paint_color(
+      has_high_contrast_foreground ? high_contrast_foreground
+                                   : get_color_with_max_contrast(background),
+      background);
+
+  double background_luminance = get_relative_luminance(background);
+
+  blend_result_t best = {ALPHA_OPAQUE, target_foreground};
+
+  uint32_t low = ALPHA_TRANSPARENT;
+  uint32_t high = ALPHA_OPAQUE + 1;
+
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    argb_t color =
+        alpha_blend_sk_alpha(target_foreground, default_foreground, mid);
+    double luminance = get_relative_luminance(color);
+    double contrast = get_contrast_ratio_float(luminance, background_luminance);
+
+    if (contrast >= contrast_ratio) {
+      best.alpha = mid;
+      best.color = color;
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+
+  return best;
+}
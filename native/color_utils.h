@@ -0,0 +1,71 @@
+/**
+ * @license
+ * Copyright 2012 The Chromium Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Source: chromium/src/main/ui/gfx/color_utils.h
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#ifndef OMARCHY_COLOR_UTILS_H
+#define OMARCHY_COLOR_UTILS_H
+
+#include <stdint.h>
+
+// packed 0xAARRGGBB color
+typedef uint32_t argb_t;
+
+#define ALPHA_OPAQUE 0xffu
+#define ALPHA_TRANSPARENT 0x00u
+#define ARGB_WHITE 0xffffffffu
+#define ARGB_TRANSPARENT 0x00000000u
+
+// hue, saturation and lightness, each in 0.0..1.0
+typedef struct {
+  double h;
+  double s;
+  double l;
+} hsl_t;
+
+typedef struct {
+  uint32_t alpha;
+  argb_t color;
+} blend_result_t;
+
+static inline argb_t argb_from_rgb(uint8_t r, uint8_t g, uint8_t b) {
+  return (ALPHA_OPAQUE << 24) | ((argb_t)r << 16) | ((argb_t)g << 8) |
+         (argb_t)b;
+}
+
+static inline uint8_t alpha_from_argb(argb_t c) { return (c >> 24) & 0xff; }
+static inline uint8_t red_from_argb(argb_t c) { return (c >> 16) & 0xff; }
+static inline uint8_t green_from_argb(argb_t c) { return (c >> 8) & 0xff; }
+static inline uint8_t blue_from_argb(argb_t c) { return c & 0xff; }
+
+static inline argb_t argb_set_a(argb_t c, uint8_t a) {
+  return (c & 0x00ffffffu) | ((argb_t)a << 24);
+}
+
+// writes "#rrggbb" (8 bytes including NUL) into dst
+void hex_from_argb(argb_t c, char dst[8]);
+
+hsl_t argb_to_hsl(argb_t c);
+argb_t hsl_to_argb(hsl_t hsl, uint8_t alpha);
+
+double get_relative_luminance(argb_t c);
+int is_dark(argb_t c);
+argb_t get_color_with_max_contrast(argb_t c);
+double get_contrast_ratio_argb(argb_t a, argb_t b);
+double get_contrast_ratio_float(double luminance_a, double luminance_b);
+
+// `background` must be opaque. pass `has_high_contrast_foreground` = 0 to
+// blend toward the max contrast color of `background`.
+blend_result_t blend_for_min_contrast(argb_t default_foreground,
+                                      argb_t background,
+                                      int has_high_contrast_foreground,
+                                      argb_t high_contrast_foreground,
+                                      double contrast_ratio);
+
+#endif
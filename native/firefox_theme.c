@@ -0,0 +1,80 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#include "firefox_theme.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "autogenerated_theme.h"
+#include "material_scheme.h"
+
+int format_firefox_theme(char *dst, size_t size, uint8_t r, uint8_t g,
+                         uint8_t b) {
+  argb_t argb = argb_from_rgb(r, g, b);
+
+  autogenerated_theme_colors_t theme_colors =
+      get_autogenerated_theme_colors(argb);
+
+  int dark = is_dark(argb);
+  material_scheme_t scheme = material_scheme_from_source(argb, dark);
+
+  hsl_t popup_base = argb_to_hsl(scheme.background);
+  hsl_t popup_tint = argb_to_hsl(scheme.primary);
+  hsl_t popup_hsl = {
+      .h = (popup_base.h * 5 + popup_tint.h) / 6,
+      .s = (popup_base.s * 5 + popup_tint.s) / 6,
+      .l = popup_base.l,
+  };
+
+  char active_tab[8], active_tab_text[8], frame[8], secondary[8],
+      on_secondary[8], primary[8], popup[8], primary_container[8],
+      outline[8], background[8];
+  hex_from_argb(theme_colors.active_tab_color, active_tab);
+  hex_from_argb(theme_colors.active_tab_text_color, active_tab_text);
+  hex_from_argb(theme_colors.frame_color, frame);
+  hex_from_argb(scheme.secondary, secondary);
+  hex_from_argb(scheme.on_secondary, on_secondary);
+  hex_from_argb(scheme.primary, primary);
+  hex_from_argb(hsl_to_argb(popup_hsl, 0), popup);
+  hex_from_argb(scheme.primary_container, primary_container);
+  hex_from_argb(scheme.outline, outline);
+  hex_from_argb(scheme.background, background);
+
+  int needed = snprintf(
+      dst, size,
+      "{\"colors\":{"
+      "\"toolbar\":\"%s\","
+      "\"toolbar_text\":\"%s\","
+      "\"frame\":\"%s\","
+      "\"tab_background_text\":\"%s\","
+      "\"toolbar_field\":\"%s\","
+      "\"toolbar_field_text\":\"%s\","
+      "\"tab_line\":\"%s\","
+      "\"popup\":\"%s\","
+      "\"popup_text\":\"%s\","
+      "\"button_background_hover\":\"%s\","
+      "\"icons\":\"%s\","
+      "\"toolbar_field_border_focus\":\"%s\","
+      "\"toolbar_field_border\":\"%s\","
+      "\"toolbar_field_focus\":\"%s\","
+      "\"toolbar_field_highlight_text\":\"%s\","
+      "\"toolbar_field_highlight\":\"%s\""
+      "},\"properties\":{\"color_scheme\":\"%s\"}}",
+      active_tab, active_tab_text, frame, secondary, on_secondary,
+      active_tab_text, primary, popup, active_tab_text, primary_container,
+      secondary, primary, outline, active_tab, background, primary,
+      dark ? "dark" : "light");
+
+  if (needed < 0) {
+    return EIO;
+  }
+  if ((size_t)needed >= size) {
+    return ERANGE;
+  }
+  return 0;
+}
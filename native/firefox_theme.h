@@ -0,0 +1,23 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_FIREFOX_THEME_H
+#define OMARCHY_FIREFOX_THEME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// upper bound for the `FirefoxTheme` json, including NUL
+#define FIREFOX_THEME_MAX 768
+
+// write the `FirefoxTheme` json object (see create-firefox-theme.js) for the
+// base color r,g,b into dst (capacity size).
+// return 0 on success or ERANGE if dst is too small.
+int format_firefox_theme(char *dst, size_t size, uint8_t r, uint8_t g,
+                         uint8_t b);
+
+#endif
@@ -0,0 +1,400 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _GNU_SOURCE
+
+#include "io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// one linked file read takes three entries; client writes are split into
+// submissions of at most this many
+#define RING_ENTRIES 64
+// the registered file slot chromium.theme is opened into
+#define FILE_SLOT 0
+
+static io_stats_t stats;
+
+// the mapped submission and completion queues. fd is -1 for the sync backend.
+static struct {
+  int fd;
+  void *sq_ptr;
+  size_t sq_size;
+  void *cq_ptr;
+  size_t cq_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+} ring = {.fd = -1};
+
+static int ring_enter(unsigned submit, unsigned wait) {
+  stats.syscalls++;
+  return (int)syscall(SYS_io_uring_enter, ring.fd, submit, wait,
+                      IORING_ENTER_GETEVENTS, NULL, 0);
+}
+
+static int ring_register(unsigned opcode, void *arg, unsigned nr_args) {
+  return (int)syscall(SYS_io_uring_register, ring.fd, opcode, arg, nr_args);
+}
+
+static void ring_unmap(void) {
+  if (ring.sqes != NULL) {
+    munmap(ring.sqes, ring.sqes_size);
+  }
+  if (ring.cq_ptr != NULL && ring.cq_ptr != ring.sq_ptr) {
+    munmap(ring.cq_ptr, ring.cq_size);
+  }
+  if (ring.sq_ptr != NULL) {
+    munmap(ring.sq_ptr, ring.sq_size);
+  }
+  if (ring.fd != -1) {
+    close(ring.fd);
+  }
+  memset(&ring, 0, sizeof(ring));
+  ring.fd = -1;
+}
+
+// the kernel must support every operation used here, and direct descriptors
+// so the read can be linked to the open
+static int ring_supported(void) {
+  size_t size = sizeof(struct io_uring_probe) +
+                IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+  struct io_uring_probe *probe = calloc(1, size);
+  if (probe == NULL) {
+    return 0;
+  }
+  int ok = ring_register(IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0;
+  static const int ops[] = {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE,
+                            IORING_OP_WRITE};
+  for (size_t i = 0; ok && i < sizeof(ops) / sizeof(ops[0]); i++) {
+    ok = ops[i] <= probe->last_op &&
+         (probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+  }
+  free(probe);
+
+  int files[1] = {-1};
+  return ok && ring_register(IORING_REGISTER_FILES, files, 1) == 0;
+}
+
+// returns 0 or errno, with the ring torn down on failure
+static int ring_setup(void) {
+  struct io_uring_params p = {0};
+  ring.fd = (int)syscall(SYS_io_uring_setup, RING_ENTRIES, &p);
+  if (ring.fd == -1) {
+    int err = errno;
+    ring.fd = -1;
+    return err;
+  }
+
+  ring.sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  ring.cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    ring.sq_size = ring.cq_size = ring.sq_size > ring.cq_size ? ring.sq_size
+                                                              : ring.cq_size;
+  }
+  ring.sq_ptr = mmap(NULL, ring.sq_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+  if (ring.sq_ptr == MAP_FAILED) {
+    ring.sq_ptr = NULL;
+    int err = errno;
+    ring_unmap();
+    return err;
+  }
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    ring.cq_ptr = ring.sq_ptr;
+  } else {
+    ring.cq_ptr = mmap(NULL, ring.cq_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+    if (ring.cq_ptr == MAP_FAILED) {
+      ring.cq_ptr = NULL;
+      int err = errno;
+      ring_unmap();
+      return err;
+    }
+  }
+  ring.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  ring.sqes = mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+  if (ring.sqes == MAP_FAILED) {
+    ring.sqes = NULL;
+    int err = errno;
+    ring_unmap();
+    return err;
+  }
+
+  char *sq = ring.sq_ptr;
+  char *cq = ring.cq_ptr;
+  ring.sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  ring.sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+  ring.sq_array = (unsigned *)(sq + p.sq_off.array);
+  ring.cq_head = (unsigned *)(cq + p.cq_off.head);
+  ring.cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  ring.cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+  ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+  if (!ring_supported()) {
+    ring_unmap();
+    return EOPNOTSUPP;
+  }
+  return 0;
+}
+
+// the next free submission entry, zeroed, tagged with `data`. the caller
+// never queues more than RING_ENTRIES before ring_submit.
+static struct io_uring_sqe *ring_sqe(unsigned *queued, uint64_t data) {
+  unsigned tail = *ring.sq_tail + *queued;
+  unsigned idx = tail & *ring.sq_mask;
+  struct io_uring_sqe *sqe = &ring.sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = data;
+  ring.sq_array[idx] = idx;
+  (*queued)++;
+  return sqe;
+}
+
+// errors io_uring_enter returns while the ring is still usable: a signal, or
+// no room yet for the kernel's own bookkeeping
+static int ring_busy(int err) {
+  return err == EINTR || err == EAGAIN || err == EBUSY;
+}
+
+// submit `queued` entries and wait for as many completions, passing each to
+// `done`. returns 0 or errno, in which case nothing was submitted.
+//
+// every entry is handed to `done` exactly once. should the ring fail once
+// some are in flight, it is torn down, so none of them can complete into a
+// later submission, and the rest are reported as -ECANCELED; from then on
+// the host uses plain syscalls.
+static int ring_submit(unsigned queued,
+                       void (*done)(uint64_t data, int res, void *ctx),
+                       void *ctx) {
+  __atomic_store_n(ring.sq_tail, *ring.sq_tail + queued, __ATOMIC_RELEASE);
+
+  unsigned submitted = 0;
+  while (submitted < queued) {
+    int n = ring_enter(queued - submitted, queued - submitted);
+    if (n == -1) {
+      if (ring_busy(errno)) {
+        continue;
+      }
+      if (submitted == 0) {
+        // take the entries back so the ring stays in step
+        __atomic_store_n(ring.sq_tail, *ring.sq_tail - queued,
+                         __ATOMIC_RELEASE);
+        return errno;
+      }
+      break;
+    }
+    submitted += (unsigned)n;
+  }
+
+  // bit i is set once the entry tagged i has completed; queued is at most
+  // RING_ENTRIES, which fits
+  uint64_t completed = 0;
+  unsigned reaped = 0;
+  while (reaped < submitted) {
+    unsigned head = *ring.cq_head;
+    unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      if (ring_enter(0, submitted - reaped) == -1 && !ring_busy(errno)) {
+        break;
+      }
+      continue;
+    }
+    for (; head != tail; head++) {
+      struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+      uint64_t data = cqe->user_data;
+      // anything else belongs to no entry of this submission
+      if (data < queued && !(completed & (UINT64_C(1) << data))) {
+        completed |= UINT64_C(1) << data;
+        reaped++;
+        done(data, cqe->res, ctx);
+      }
+    }
+    __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+  }
+
+  if (reaped < queued) {
+    fprintf(stderr, "io_uring failed, using plain syscalls: %s\n",
+            strerror(errno));
+    ring_unmap();
+    for (unsigned i = 0; i < queued; i++) {
+      if (!(completed & (UINT64_C(1) << i))) {
+        done(i, -ECANCELED, ctx);
+      }
+    }
+  }
+  return 0;
+}
+
+void io_open(void) {
+  if (ring.fd != -1) {
+    return;
+  }
+
+  const char *env = getenv(IO_BACKEND_ENV);
+  if (env == NULL || *env == '\0' || strcmp(env, "sync") == 0) {
+    return;
+  }
+  if (strcmp(env, "uring") != 0) {
+    fprintf(stderr, "ignoring %s='%s', expected uring or sync\n",
+            IO_BACKEND_ENV, env);
+    return;
+  }
+
+  // kernels before 5.15, or with io_uring disabled by sysctl or seccomp
+  int ret = ring_setup();
+  if (ret != 0) {
+    fprintf(stderr, "io_uring unavailable, using plain syscalls: %s\n",
+            strerror(ret));
+  }
+}
+
+void io_close(void) { ring_unmap(); }
+
+const char *io_backend(void) { return ring.fd != -1 ? "uring" : "sync"; }
+
+const io_stats_t *io_stats(void) { return &stats; }
+
+static int read_file_sync(const char *path, char *buf, size_t size) {
+  stats.syscalls++;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return errno;
+  }
+
+  ssize_t n;
+  do {
+    stats.syscalls++;
+    n = read(fd, buf, size - 1);
+  } while (n == -1 && errno == EINTR);
+  int err = n == -1 ? errno : 0;
+
+  stats.syscalls++;
+  close(fd);
+  if (err != 0) {
+    return err;
+  }
+  buf[n] = '\0';
+  return 0;
+}
+
+// results of the linked open, read and close, by user_data
+struct read_chain {
+  int res[3];
+};
+
+static void read_done(uint64_t data, int res, void *ctx) {
+  ((struct read_chain *)ctx)->res[data] = res;
+}
+
+int io_read_file(const char *path, char *buf, size_t size) {
+  if (ring.fd == -1) {
+    return read_file_sync(path, buf, size);
+  }
+
+  unsigned queued = 0;
+  struct io_uring_sqe *sqe = ring_sqe(&queued, 0);
+  sqe->opcode = IORING_OP_OPENAT;
+  sqe->fd = AT_FDCWD;
+  sqe->addr = (uintptr_t)path;
+  // a direct descriptor is never inherited, and O_CLOEXEC is refused for one
+  sqe->open_flags = O_RDONLY;
+  sqe->file_index = FILE_SLOT + 1;
+  sqe->flags = IOSQE_IO_LINK;
+
+  // a hard link, so the slot is closed even when the read fails
+  sqe = ring_sqe(&queued, 1);
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = FILE_SLOT;
+  sqe->addr = (uintptr_t)buf;
+  sqe->len = (unsigned)(size - 1);
+  sqe->off = 0;
+  sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+
+  sqe = ring_sqe(&queued, 2);
+  sqe->opcode = IORING_OP_CLOSE;
+  sqe->file_index = FILE_SLOT + 1;
+
+  struct read_chain chain = {{0}};
+  int ret = ring_submit(queued, read_done, &chain);
+  // EINVAL: a kernel that has the operations but not direct descriptors.
+  // a ring torn down while reading cancelled it, and reading again is safe.
+  if (ret != 0 || ring.fd == -1 || chain.res[0] == -EINVAL) {
+    return read_file_sync(path, buf, size);
+  }
+  if (chain.res[0] < 0) {
+    return -chain.res[0];
+  }
+  if (chain.res[1] < 0) {
+    return -chain.res[1];
+  }
+  buf[chain.res[1]] = '\0';
+  return 0;
+}
+
+static void write_done(uint64_t data, int res, void *ctx) {
+  ((io_write_t *)ctx)[data].result = res;
+}
+
+static void write_batch_sync(io_write_t *writes, int n) {
+  for (int i = 0; i < n; i++) {
+    ssize_t r;
+    do {
+      stats.syscalls++;
+      r = write(writes[i].fd, writes[i].buf, writes[i].len);
+    } while (r == -1 && errno == EINTR);
+    writes[i].result = r == -1 ? -errno : r;
+  }
+}
+
+void io_write_batch(io_write_t *writes, int n) {
+  if (ring.fd == -1) {
+    write_batch_sync(writes, n);
+    return;
+  }
+
+  for (int start = 0; start < n; start += RING_ENTRIES) {
+    int count = n - start < RING_ENTRIES ? n - start : RING_ENTRIES;
+    if (ring.fd == -1) {
+      // torn down by a failure in an earlier submission
+      write_batch_sync(writes + start, count);
+      continue;
+    }
+    unsigned queued = 0;
+    for (int i = 0; i < count; i++) {
+      io_write_t *w = &writes[start + i];
+      struct io_uring_sqe *sqe = ring_sqe(&queued, (uint64_t)i);
+      sqe->opcode = IORING_OP_WRITE;
+      sqe->fd = w->fd;
+      sqe->addr = (uintptr_t)w->buf;
+      sqe->len = (unsigned)w->len;
+      // pipes and sockets have no offset; -1 means the current position
+      sqe->off = (uint64_t)-1;
+      // io_uring would otherwise wait for room even on an O_NONBLOCK file,
+      // instead of failing with EAGAIN like write() does
+      sqe->rw_flags = RWF_NOWAIT;
+    }
+    if (ring_submit(queued, write_done, writes + start) != 0) {
+      write_batch_sync(writes + start, count);
+    }
+  }
+}
@@ -0,0 +1,51 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_IO_H
+#define OMARCHY_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// "uring" opts in to io_uring, used when the kernel has what it needs; plain
+// syscalls ("sync") otherwise. see native/bench/io-backends.c.
+#define IO_BACKEND_ENV "OMARCHY_FIREFOX_THEME_IO"
+
+typedef struct {
+  uint64_t syscalls; // syscalls made for file reads and client writes
+} io_stats_t;
+
+// one write of an io_write_batch
+typedef struct {
+  int fd;
+  const void *buf;
+  size_t len;
+  ssize_t result; // bytes written, or -errno
+} io_write_t;
+
+// pick the backend from IO_BACKEND_ENV, falling back to plain syscalls when
+// io_uring cannot be set up. safe to call again after io_close.
+void io_open(void);
+
+void io_close(void);
+
+// "uring" or "sync"
+const char *io_backend(void);
+
+// read up to size - 1 bytes from the start of `path` into buf and NUL
+// terminate them. with io_uring the open, read and close are submitted as one
+// linked chain. returns 0 or errno.
+int io_read_file(const char *path, char *buf, size_t size);
+
+// attempt each write once, without retrying short writes, and store its
+// result. with io_uring every write goes out in a single submission.
+void io_write_batch(io_write_t *writes, int n);
+
+const io_stats_t *io_stats(void);
+
+#endif
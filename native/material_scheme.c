@@ -0,0 +1,552 @@
+/**
+ * @license
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Source: @material/material-color-utilities (hct/, palettes/, scheme/)
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#include "material_scheme.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define PI 3.14159265358979323846
+
+static const double SRGB_TO_XYZ[3][3] = {
+    {0.41233895, 0.35762064, 0.18051042},
+    {0.2126, 0.7152, 0.0722},
+    {0.01932141, 0.11916382, 0.95034478},
+};
+
+static const double WHITE_POINT_D65[3] = {95.047, 100.0, 108.883};
+
+static const double SCALED_DISCOUNT_FROM_LINRGB[3][3] = {
+    {0.001200833568784504, 0.002389694492170889, 0.0002795742885861124},
+    {0.0005891086651375999, 0.0029785502573438758, 0.0003270666104008398},
+    {0.00010146692491640572, 0.0005364214359186694, 0.0032979401770712076},
+};
+
+static const double LINRGB_FROM_SCALED_DISCOUNT[3][3] = {
+    {1373.2198709594231, -1100.4251190754821, -7.278681089101213},
+    {-271.815969077903, 559.6580465940733, -32.46047482791194},
+    {1.9622899599665666, -57.173814538844006, 308.7233197812385},
+};
+
+static const double Y_FROM_LINRGB[3] = {0.2126, 0.7152, 0.0722};
+
+typedef struct {
+  double n;
+  double aw;
+  double nbb;
+  double ncb;
+  double c;
+  double nc;
+  double rgb_d[3];
+  double fl;
+  double f_l_root;
+  double z;
+} viewing_conditions_t;
+
+static viewing_conditions_t vc;
+static double critical_planes[255];
+static int initialized = 0;
+
+// round half up like javascript's Math.round
+static double js_round(double x) {
+  double r = floor(x);
+  return (x - r >= 0.5) ? r + 1.0 : r;
+}
+
+static double signum(double x) { return x < 0 ? -1.0 : x == 0 ? 0.0 : 1.0; }
+
+static double lerp(double start, double stop, double amount) {
+  return (1.0 - amount) * start + amount * stop;
+}
+
+static double sanitize_degrees(double degrees) {
+  degrees = fmod(degrees, 360.0);
+  if (degrees < 0) {
+    degrees += 360.0;
+  }
+  return degrees;
+}
+
+static double sanitize_radians(double angle) {
+  return fmod(angle + PI * 8, PI * 2);
+}
+
+static void matrix_multiply(const double row[3], const double m[3][3],
+                            double out[3]) {
+  double a = row[0] * m[0][0] + row[1] * m[0][1] + row[2] * m[0][2];
+  double b = row[0] * m[1][0] + row[1] * m[1][1] + row[2] * m[1][2];
+  double c = row[0] * m[2][0] + row[1] * m[2][1] + row[2] * m[2][2];
+  out[0] = a;
+  out[1] = b;
+  out[2] = c;
+}
+
+// 0..255 component to linear 0..100
+static double linearized(double rgb_component) {
+  double normalized = rgb_component / 255.0;
+  if (normalized <= 0.040449936) {
+    return normalized / 12.92 * 100.0;
+  }
+  return pow((normalized + 0.055) / 1.055, 2.4) * 100.0;
+}
+
+// linear 0..100 to unrounded 0..255 component
+static double true_delinearized(double rgb_component) {
+  double normalized = rgb_component / 100.0;
+  double delinearized = normalized <= 0.0031308
+                            ? normalized * 12.92
+                            : 1.055 * pow(normalized, 1.0 / 2.4) - 0.055;
+  return delinearized * 255.0;
+}
+
+static uint8_t delinearized(double rgb_component) {
+  double v = js_round(true_delinearized(rgb_component));
+  return v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+}
+
+static double lab_f(double t) {
+  const double e = 216.0 / 24389.0;
+  const double kappa = 24389.0 / 27.0;
+  return t > e ? pow(t, 1.0 / 3.0) : (kappa * t + 16) / 116;
+}
+
+static double lab_invf(double ft) {
+  const double e = 216.0 / 24389.0;
+  const double kappa = 24389.0 / 27.0;
+  double ft3 = ft * ft * ft;
+  return ft3 > e ? ft3 : (116 * ft - 16) / kappa;
+}
+
+static double y_from_lstar(double lstar) {
+  return 100.0 * lab_invf((lstar + 16.0) / 116.0);
+}
+
+static double lstar_from_argb(argb_t argb) {
+  double lin[3] = {linearized(red_from_argb(argb)),
+                   linearized(green_from_argb(argb)),
+                   linearized(blue_from_argb(argb))};
+  double xyz[3];
+  matrix_multiply(lin, SRGB_TO_XYZ, xyz);
+  return 116.0 * lab_f(xyz[1] / 100.0) - 16.0;
+}
+
+static argb_t argb_from_lstar(double lstar) {
+  uint8_t component = delinearized(y_from_lstar(lstar));
+  return argb_from_rgb(component, component, component);
+}
+
+static argb_t argb_from_linrgb(const double linrgb[3]) {
+  return argb_from_rgb(delinearized(linrgb[0]), delinearized(linrgb[1]),
+                       delinearized(linrgb[2]));
+}
+
+// `ViewingConditions.DEFAULT` plus the critical plane table of `HctSolver`
+static void init(void) {
+  if (initialized) {
+    return;
+  }
+
+  const double *xyz = WHITE_POINT_D65;
+  const double adapting_luminance = (200.0 / PI) * y_from_lstar(50.0) / 100.0;
+  const double background_lstar = 50.0;
+  const double surround = 2.0;
+
+  double r_w = xyz[0] * 0.401288 + xyz[1] * 0.650173 + xyz[2] * -0.051461;
+  double g_w = xyz[0] * -0.250268 + xyz[1] * 1.204414 + xyz[2] * 0.045854;
+  double b_w = xyz[0] * -0.002079 + xyz[1] * 0.048952 + xyz[2] * 0.953127;
+
+  double f = 0.8 + surround / 10.0;
+  double c = f >= 0.9 ? lerp(0.59, 0.69, (f - 0.9) * 10.0)
+                      : lerp(0.525, 0.59, (f - 0.8) * 10.0);
+  double d = f * (1.0 - (1.0 / 3.6) * exp((-adapting_luminance - 42.0) / 92.0));
+  d = d > 1.0 ? 1.0 : d < 0.0 ? 0.0 : d;
+
+  double rgb_d[3] = {
+      d * (100.0 / r_w) + 1.0 - d,
+      d * (100.0 / g_w) + 1.0 - d,
+      d * (100.0 / b_w) + 1.0 - d,
+  };
+
+  double k = 1.0 / (5.0 * adapting_luminance + 1.0);
+  double k4 = k * k * k * k;
+  double k4f = 1.0 - k4;
+  double fl = k4 * adapting_luminance +
+              0.1 * k4f * k4f * cbrt(5.0 * adapting_luminance);
+  double n = y_from_lstar(background_lstar) / xyz[1];
+  double z = 1.48 + sqrt(n);
+  double nbb = 0.725 / pow(n, 0.2);
+
+  double rgb_a_factors[3] = {
+      pow(fl * rgb_d[0] * r_w / 100.0, 0.42),
+      pow(fl * rgb_d[1] * g_w / 100.0, 0.42),
+      pow(fl * rgb_d[2] * b_w / 100.0, 0.42),
+  };
+  double rgb_a[3];
+  for (int i = 0; i < 3; i++) {
+    rgb_a[i] = (400.0 * rgb_a_factors[i]) / (rgb_a_factors[i] + 27.13);
+  }
+  double aw = (2.0 * rgb_a[0] + rgb_a[1] + 0.05 * rgb_a[2]) * nbb;
+
+  vc = (viewing_conditions_t){
+      .n = n,
+      .aw = aw,
+      .nbb = nbb,
+      .ncb = nbb,
+      .c = c,
+      .nc = f,
+      .rgb_d = {rgb_d[0], rgb_d[1], rgb_d[2]},
+      .fl = fl,
+      .f_l_root = pow(fl, 0.25),
+      .z = z,
+  };
+
+  for (int i = 0; i < 255; i++) {
+    critical_planes[i] = linearized(i + 0.5);
+  }
+
+  initialized = 1;
+}
+
+// `Cam16.fromInt`, keeping only hue and chroma
+static void cam16_hue_chroma(argb_t argb, double *hue_out,
+                             double *chroma_out) {
+  double red_l = linearized(red_from_argb(argb));
+  double green_l = linearized(green_from_argb(argb));
+  double blue_l = linearized(blue_from_argb(argb));
+
+  double x = 0.41233895 * red_l + 0.35762064 * green_l + 0.18051042 * blue_l;
+  double y = 0.2126 * red_l + 0.7152 * green_l + 0.0722 * blue_l;
+  double z = 0.01932141 * red_l + 0.11916382 * green_l + 0.95034478 * blue_l;
+
+  double r_c = 0.401288 * x + 0.650173 * y - 0.051461 * z;
+  double g_c = -0.250268 * x + 1.204414 * y + 0.045854 * z;
+  double b_c = -0.002079 * x + 0.048952 * y + 0.953127 * z;
+
+  double r_d = vc.rgb_d[0] * r_c;
+  double g_d = vc.rgb_d[1] * g_c;
+  double b_d = vc.rgb_d[2] * b_c;
+
+  double r_af = pow((vc.fl * fabs(r_d)) / 100.0, 0.42);
+  double g_af = pow((vc.fl * fabs(g_d)) / 100.0, 0.42);
+  double b_af = pow((vc.fl * fabs(b_d)) / 100.0, 0.42);
+
+  double r_a = (signum(r_d) * 400.0 * r_af) / (r_af + 27.13);
+  double g_a = (signum(g_d) * 400.0 * g_af) / (g_af + 27.13);
+  double b_a = (signum(b_d) * 400.0 * b_af) / (b_af + 27.13);
+
+  double a = (11.0 * r_a + -12.0 * g_a + b_a) / 11.0;
+  double b = (r_a + g_a - 2.0 * b_a) / 9.0;
+  double u = (20.0 * r_a + 20.0 * g_a + 21.0 * b_a) / 20.0;
+  double p2 = (40.0 * r_a + 20.0 * g_a + b_a) / 20.0;
+
+  double atan_degrees = (atan2(b, a) * 180.0) / PI;
+  double hue = atan_degrees < 0          ? atan_degrees + 360.0
+               : atan_degrees >= 360.0 ? atan_degrees - 360.0
+                                         : atan_degrees;
+
+  double ac = p2 * vc.nbb;
+  double j = 100.0 * pow(ac / vc.aw, vc.c * vc.z);
+
+  double hue_prime = hue < 20.14 ? hue + 360 : hue;
+  double e_hue = 0.25 * (cos((hue_prime * PI) / 180.0 + 2.0) + 3.8);
+  double p1 = (50000.0 / 13.0) * e_hue * vc.nc * vc.ncb;
+  double t = (p1 * sqrt(a * a + b * b)) / (u + 0.305);
+  double alpha = pow(t, 0.9) * pow(1.64 - pow(0.29, vc.n), 0.73);
+
+  *hue_out = hue;
+  *chroma_out = alpha * sqrt(j / 100.0);
+}
+
+static double chromatic_adaptation(double component) {
+  double af = pow(fabs(component), 0.42);
+  return (signum(component) * 400.0 * af) / (af + 27.13);
+}
+
+static double inverse_chromatic_adaptation(double adapted) {
+  double adapted_abs = fabs(adapted);
+  double base = fmax(0, (27.13 * adapted_abs) / (400.0 - adapted_abs));
+  return signum(adapted) * pow(base, 1.0 / 0.42);
+}
+
+// hue of a linear rgb color in radians, in the CAM16 a/b plane
+static double hue_of(const double linrgb[3]) {
+  double scaled_discount[3];
+  matrix_multiply(linrgb, SCALED_DISCOUNT_FROM_LINRGB, scaled_discount);
+  double r_a = chromatic_adaptation(scaled_discount[0]);
+  double g_a = chromatic_adaptation(scaled_discount[1]);
+  double b_a = chromatic_adaptation(scaled_discount[2]);
+  double a = (11.0 * r_a + -12.0 * g_a + b_a) / 11.0;
+  double b = (r_a + g_a - 2.0 * b_a) / 9.0;
+  return atan2(b, a);
+}
+
+static int are_in_cyclic_order(double a, double b, double c) {
+  double delta_a_b = sanitize_radians(b - a);
+  double delta_a_c = sanitize_radians(c - a);
+  return delta_a_b < delta_a_c;
+}
+
+static double intercept(double source, double mid, double target) {
+  return (mid - source) / (target - source);
+}
+
+static void set_coordinate(const double source[3], double coordinate,
+                           const double target[3], int axis, double out[3]) {
+  double t = intercept(source[axis], coordinate, target[axis]);
+  for (int i = 0; i < 3; i++) {
+    out[i] = source[i] + (target[i] - source[i]) * t;
+  }
+}
+
+static int is_bounded(double x) { return 0.0 <= x && x <= 100.0; }
+
+// nth vertex of the rgb cube slice at luminance y; out[0] < 0 if it lies
+// outside the cube
+static void nth_vertex(double y, int n, double out[3]) {
+  const double k_r = Y_FROM_LINRGB[0];
+  const double k_g = Y_FROM_LINRGB[1];
+  const double k_b = Y_FROM_LINRGB[2];
+  double coord_a = n % 4 <= 1 ? 0.0 : 100.0;
+  double coord_b = n % 2 == 0 ? 0.0 : 100.0;
+
+  out[0] = out[1] = out[2] = -1.0;
+  if (n < 4) {
+    double g = coord_a, b = coord_b;
+    double r = (y - g * k_g - b * k_b) / k_r;
+    if (is_bounded(r)) {
+      out[0] = r, out[1] = g, out[2] = b;
+    }
+  } else if (n < 8) {
+    double b = coord_a, r = coord_b;
+    double g = (y - r * k_r - b * k_b) / k_g;
+    if (is_bounded(g)) {
+      out[0] = r, out[1] = g, out[2] = b;
+    }
+  } else {
+    double r = coord_a, g = coord_b;
+    double b = (y - r * k_r - g * k_g) / k_b;
+    if (is_bounded(b)) {
+      out[0] = r, out[1] = g, out[2] = b;
+    }
+  }
+}
+
+static void bisect_to_segment(double y, double target_hue, double left[3],
+                              double right[3]) {
+  double left_hue = 0.0, right_hue = 0.0;
+  int found = 0, uncut = 1;
+
+  left[0] = left[1] = left[2] = -1.0;
+  right[0] = right[1] = right[2] = -1.0;
+
+  for (int n = 0; n < 12; n++) {
+    double mid[3];
+    nth_vertex(y, n, mid);
+    if (mid[0] < 0) {
+      continue;
+    }
+    double mid_hue = hue_of(mid);
+    if (!found) {
+      for (int i = 0; i < 3; i++) {
+        left[i] = right[i] = mid[i];
+      }
+      left_hue = right_hue = mid_hue;
+      found = 1;
+      continue;
+    }
+    if (uncut || are_in_cyclic_order(left_hue, mid_hue, right_hue)) {
+      uncut = 0;
+      if (are_in_cyclic_order(left_hue, target_hue, mid_hue)) {
+        for (int i = 0; i < 3; i++) {
+          right[i] = mid[i];
+        }
+        right_hue = mid_hue;
+      } else {
+        for (int i = 0; i < 3; i++) {
+          left[i] = mid[i];
+        }
+        left_hue = mid_hue;
+      }
+    }
+  }
+}
+
+static void bisect_to_limit(double y, double target_hue, double out[3]) {
+  double left[3], right[3];
+  bisect_to_segment(y, target_hue, left, right);
+  double left_hue = hue_of(left);
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (left[axis] == right[axis]) {
+      continue;
+    }
+    int l_plane, r_plane;
+    if (left[axis] < right[axis]) {
+      l_plane = (int)floor(true_delinearized(left[axis]) - 0.5);
+      r_plane = (int)ceil(true_delinearized(right[axis]) - 0.5);
+    } else {
+      l_plane = (int)ceil(true_delinearized(left[axis]) - 0.5);
+      r_plane = (int)floor(true_delinearized(right[axis]) - 0.5);
+    }
+    for (int i = 0; i < 8; i++) {
+      if (abs(r_plane - l_plane) <= 1) {
+        break;
+      }
+      int m_plane = (int)floor((l_plane + r_plane) / 2.0);
+      double mid[3];
+      set_coordinate(left, critical_planes[m_plane], right, axis, mid);
+      double mid_hue = hue_of(mid);
+      if (are_in_cyclic_order(left_hue, target_hue, mid_hue)) {
+        for (int k = 0; k < 3; k++) {
+          right[k] = mid[k];
+        }
+        r_plane = m_plane;
+      } else {
+        for (int k = 0; k < 3; k++) {
+          left[k] = mid[k];
+        }
+        left_hue = mid_hue;
+        l_plane = m_plane;
+      }
+    }
+  }
+
+  for (int i = 0; i < 3; i++) {
+    out[i] = (left[i] + right[i]) / 2.0;
+  }
+}
+
+// newton's method on J; returns 0 when no in-gamut answer was found
+static argb_t find_result_by_j(double hue_radians, double chroma, double y) {
+  double j = sqrt(y) * 11.0;
+
+  const double t_inner_coeff = 1 / pow(1.64 - pow(0.29, vc.n), 0.73);
+  const double e_hue = 0.25 * (cos(hue_radians + 2.0) + 3.8);
+  const double p1 = e_hue * (50000.0 / 13.0) * vc.nc * vc.ncb;
+  const double h_sin = sin(hue_radians);
+  const double h_cos = cos(hue_radians);
+
+  for (int round = 0; round < 5; round++) {
+    double j_normalized = j / 100.0;
+    double alpha =
+        chroma == 0.0 || j == 0.0 ? 0.0 : chroma / sqrt(j_normalized);
+    double t = pow(alpha * t_inner_coeff, 1.0 / 0.9);
+    double ac = vc.aw * pow(j_normalized, 1.0 / vc.c / vc.z);
+    double p2 = ac / vc.nbb;
+    double gamma = (23.0 * (p2 + 0.305) * t) /
+                   (23.0 * p1 + 11 * t * h_cos + 108.0 * t * h_sin);
+    double a = gamma * h_cos;
+    double b = gamma * h_sin;
+    double r_a = (460.0 * p2 + 451.0 * a + 288.0 * b) / 1403.0;
+    double g_a = (460.0 * p2 - 891.0 * a - 261.0 * b) / 1403.0;
+    double b_a = (460.0 * p2 - 220.0 * a - 6300.0 * b) / 1403.0;
+    double scaled[3] = {
+        inverse_chromatic_adaptation(r_a),
+        inverse_chromatic_adaptation(g_a),
+        inverse_chromatic_adaptation(b_a),
+    };
+    double linrgb[3];
+    matrix_multiply(scaled, LINRGB_FROM_SCALED_DISCOUNT, linrgb);
+
+    if (linrgb[0] < 0 || linrgb[1] < 0 || linrgb[2] < 0) {
+      return 0;
+    }
+    double fnj = Y_FROM_LINRGB[0] * linrgb[0] + Y_FROM_LINRGB[1] * linrgb[1] +
+                 Y_FROM_LINRGB[2] * linrgb[2];
+    if (fnj <= 0) {
+      return 0;
+    }
+    if (round == 4 || fabs(fnj - y) < 0.002) {
+      if (linrgb[0] > 100.01 || linrgb[1] > 100.01 || linrgb[2] > 100.01) {
+        return 0;
+      }
+      return argb_from_linrgb(linrgb);
+    }
+    j = j - ((fnj - y) * j) / (2 * fnj);
+  }
+  return 0;
+}
+
+hct_t hct_from_argb(argb_t argb) {
+  init();
+  hct_t hct;
+  cam16_hue_chroma(argb, &hct.hue, &hct.chroma);
+  hct.tone = lstar_from_argb(argb);
+  return hct;
+}
+
+argb_t hct_to_argb(double hue, double chroma, double tone) {
+  init();
+  if (chroma < 0.0001 || tone < 0.0001 || tone > 99.9999) {
+    return argb_from_lstar(tone);
+  }
+  hue = sanitize_degrees(hue);
+  double hue_radians = hue / 180 * PI;
+  double y = y_from_lstar(tone);
+  argb_t exact = find_result_by_j(hue_radians, chroma, y);
+  if (exact != 0) {
+    return exact;
+  }
+  double linrgb[3];
+  bisect_to_limit(y, hue_radians, linrgb);
+  return argb_from_linrgb(linrgb);
+}
+
+// `Hct.isYellow`
+static int is_yellow(double hue) { return hue >= 105.0 && hue < 125.0; }
+
+// `TonalPalette.averageArgb`: the per channel midpoint, rounded like
+// Math.round
+static argb_t average_argb(argb_t a, argb_t b) {
+  return argb_from_rgb(
+      (uint8_t)js_round((red_from_argb(a) + red_from_argb(b)) / 2.0),
+      (uint8_t)js_round((green_from_argb(a) + green_from_argb(b)) / 2.0),
+      (uint8_t)js_round((blue_from_argb(a) + blue_from_argb(b)) / 2.0));
+}
+
+// `TonalPalette.tone`: tone 99 of a yellow palette solved directly comes out
+// greenish, so the library takes the midpoint of tones 98 and 100 instead
+static argb_t palette_tone(double hue, double chroma, int tone) {
+  if (tone == 99 && is_yellow(hue)) {
+    return average_argb(hct_to_argb(hue, chroma, 98),
+                        hct_to_argb(hue, chroma, 100));
+  }
+  return hct_to_argb(hue, chroma, tone);
+}
+
+material_scheme_t material_scheme_from_source(argb_t source, int dark) {
+  // `CorePalette.of`: only the a1, a2, n1 and n2 palettes are read
+  hct_t hct = hct_from_argb(source);
+  double a1_chroma = fmax(48.0, hct.chroma);
+  double a2_chroma = 16.0;
+  double n1_chroma = 4.0;
+  double n2_chroma = 8.0;
+
+  // tones from `Scheme.dark` / `Scheme.light`
+  return (material_scheme_t){
+      .primary = palette_tone(hct.hue, a1_chroma, dark ? 80 : 40),
+      .primary_container = palette_tone(hct.hue, a1_chroma, dark ? 30 : 90),
+      .secondary = palette_tone(hct.hue, a2_chroma, dark ? 80 : 40),
+      .on_secondary = palette_tone(hct.hue, a2_chroma, dark ? 20 : 100),
+      .outline = palette_tone(hct.hue, n2_chroma, dark ? 60 : 50),
+      .background = palette_tone(hct.hue, n1_chroma, dark ? 10 : 99),
+  };
+}
@@ -0,0 +1,53 @@
+/**
+ * @license
+ * Copyright 2021 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Source: @material/material-color-utilities (hct/, palettes/, scheme/)
+ *
+ * Ported by VannRR <https://github.com/vannrr> 2025
+ */
+
+#ifndef OMARCHY_MATERIAL_SCHEME_H
+#define OMARCHY_MATERIAL_SCHEME_H
+
+#include "color_utils.h"
+
+// hue (0..360), chroma and tone (0..100) under the default viewing conditions
+typedef struct {
+  double hue;
+  double chroma;
+  double tone;
+} hct_t;
+
+// the subset of a material `Scheme` read by the firefox theme
+typedef struct {
+  argb_t primary;
+  argb_t primary_container;
+  argb_t secondary;
+  argb_t on_secondary;
+  argb_t outline;
+  argb_t background;
+} material_scheme_t;
+
+hct_t hct_from_argb(argb_t argb);
+
+// closest in-gamut color to the requested hue, chroma and tone
+argb_t hct_to_argb(double hue, double chroma, double tone);
+
+// equivalent to `themeFromSourceColor(source).schemes[dark ? "dark" :
+// "light"]` restricted to the roles above
+material_scheme_t material_scheme_from_source(argb_t source, int dark);
+
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _GNU_SOURCE
+
+#include "message.h"
+
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "firefox_theme.h"
+
+#define THEME_MEMBER_MAX (FIREFOX_THEME_MAX + 16)
+
+static char esc_err[MSG_MAX];
+static char esc_syserr[MSG_MAX];
+static char theme_member[THEME_MEMBER_MAX];
+
+uint64_t hash_bytes(const char *s, size_t len) {
+  uint64_t h = 0xcbf29ce484222325u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= (unsigned char)s[i];
+    h *= 0x100000001b3u;
+  }
+  return h;
+}
+
+/*
+ * Escapes `src` (length src_len) into `dst` (size dst_size).
+ * Returns number of bytes written (excluding NUL) or -1 if dst was too small.
+ *
+ * dst_size must include space for the terminating NUL.
+ */
+static ssize_t json_escape(const char *src, size_t src_len, char *dst,
+                           size_t dst_size) {
+  if (!src || !dst || dst_size == 0)
+    return -1;
+  size_t si = 0, di = 0;
+  static const char hex[] = "0123456789abcdef";
+
+  while (si < src_len) {
+    unsigned char c = (unsigned char)src[si++];
+
+    /* worst-case expansion: \u00XX -> 6 bytes, ensure space conservatively */
+    if (di + 6 >= dst_size)
+      return -1;
+
+    switch (c) {
+    case '\"':
+      dst[di++] = '\\';
+      dst[di++] = '\"';
+      break;
+    case '\\':
+      dst[di++] = '\\';
+      dst[di++] = '\\';
+      break;
+    case '\b':
+      dst[di++] = '\\';
+      dst[di++] = 'b';
+      break;
+    case '\f':
+      dst[di++] = '\\';
+      dst[di++] = 'f';
+      break;
+    case '\n':
+      dst[di++] = '\\';
+      dst[di++] = 'n';
+      break;
+    case '\r':
+      dst[di++] = '\\';
+      dst[di++] = 'r';
+      break;
+    case '\t':
+      dst[di++] = '\\';
+      dst[di++] = 't';
+      break;
+    default:
+      if (c < 0x20) {
+        dst[di++] = '\\';
+        dst[di++] = 'u';
+        dst[di++] = '0';
+        dst[di++] = '0';
+        dst[di++] = hex[(c >> 4) & 0xF];
+        dst[di++] = hex[c & 0xF];
+      } else {
+        dst[di++] = (char)c;
+      }
+    }
+  }
+
+  if (di >= dst_size)
+    return -1;
+  dst[di] = '\0';
+  return (ssize_t)di;
+}
+
+// fill in the length header for the json already in the frame body
+static void seal_frame(frame_t *frame) {
+  uint32_t len = (uint32_t)strlen(frame->data + FRAME_HEADER_SIZE);
+  uint32_t len_le = htole32(len);
+  memcpy(frame->data, &len_le, FRAME_HEADER_SIZE);
+  frame->size = FRAME_HEADER_SIZE + len;
+}
+
+int snprintf_werr(char *s, size_t maxlen, const char *format, ...) {
+  if (s == NULL || maxlen == 0 || format == NULL)
+    return EINVAL;
+
+  va_list ap;
+  va_start(ap, format);
+  int needed = vsnprintf(s, maxlen, format, ap);
+  va_end(ap);
+
+  if (needed < 0) {
+    return EIO;
+  }
+
+  if ((size_t)needed >= maxlen) {
+    return ERANGE;
+  }
+
+  return 0;
+}
+
+int parse_rgb(const char *rgb, uint8_t out[3]) {
+  const char *p = rgb;
+  for (int i = 0; i < 3; i++) {
+    if (*p < '0' || *p > '9') {
+      return EINVAL;
+    }
+    unsigned v = 0;
+    while (*p >= '0' && *p <= '9') {
+      v = v * 10 + (unsigned)(*p++ - '0');
+      if (v > 255) {
+        return EINVAL;
+      }
+    }
+    out[i] = (uint8_t)v;
+    if (*p != (i < 2 ? ',' : '\0')) {
+      return EINVAL;
+    }
+    p++;
+  }
+  return 0;
+}
+
+// build the complete firefox theme for `rgb` and write the `"theme":{...},`
+// member into dst (THEME_MEMBER_MAX). leaves dst empty if rgb cannot be
+// parsed, in which case the extension builds the theme itself.
+static void format_theme_member(char *dst, const char *rgb) {
+  uint8_t c[3];
+  if (parse_rgb(rgb, c) != 0) {
+    return;
+  }
+
+  char theme[FIREFOX_THEME_MAX];
+  if (format_firefox_theme(theme, sizeof(theme), c[0], c[1], c[2]) != 0 ||
+      snprintf_werr(dst, THEME_MEMBER_MAX, "\"theme\":%s,", theme) != 0) {
+    dst[0] = '\0';
+  }
+}
+
+int format_frame(frame_t *frame, const char *rgb, const char *err, int en) {
+  char *msg = frame->data + FRAME_HEADER_SIZE;
+  esc_err[0] = '\0';
+  esc_syserr[0] = '\0';
+  theme_member[0] = '\0';
+  frame->size = 0;
+
+  if (rgb != NULL && err == NULL) {
+    format_theme_member(theme_member, rgb);
+  }
+
+  const char *syserr = (err != NULL) ? strerror(en) : NULL;
+
+  if (err != NULL) {
+    ssize_t r = json_escape(err, strlen(err), esc_err, sizeof(esc_err));
+    if (r < 0) {
+      snprintf(esc_err, sizeof(esc_err), "error too long");
+      esc_err[sizeof(esc_err) - 1] = '\0';
+    }
+  }
+
+  if (syserr != NULL) {
+    ssize_t r2 =
+        json_escape(syserr, strlen(syserr), esc_syserr, sizeof(esc_syserr));
+    if (r2 < 0) {
+      snprintf(esc_syserr, sizeof(esc_syserr), "error too long");
+      esc_syserr[sizeof(esc_syserr) - 1] = '\0';
+    }
+  }
+
+  int ret = 1;
+  if (rgb != NULL && err != NULL) {
+    ret = snprintf_werr(msg, MSG_MAX, "{\"rgb\":[%s],\"error\":\"%s: %s\"}",
+                        rgb, esc_err, esc_syserr);
+  } else if (rgb != NULL && err == NULL) {
+    ret = snprintf_werr(msg, MSG_MAX, "{\"rgb\":[%s],%s\"error\":null}", rgb,
+                        theme_member);
+  } else if (rgb == NULL && err != NULL) {
+    ret = snprintf_werr(msg, MSG_MAX, "{\"rgb\":null,\"error\":\"%s: %s\"}",
+                        esc_err, esc_syserr);
+  } else {
+    ret = snprintf_werr(msg, MSG_MAX, "{\"rgb\":null,\"error\":null}");
+  }
+
+  if (ret != 0) {
+    return ret;
+  }
+
+  seal_frame(frame);
+  return 0;
+}
+
+int format_reply(frame_t *frame, const char *format, ...) {
+  char *msg = frame->data + FRAME_HEADER_SIZE;
+  frame->size = 0;
+
+  va_list ap;
+  va_start(ap, format);
+  int needed = vsnprintf(msg, MSG_MAX, format, ap);
+  va_end(ap);
+  if (needed < 0) {
+    return EIO;
+  }
+  if ((size_t)needed >= MSG_MAX) {
+    return ERANGE;
+  }
+
+  seal_frame(frame);
+  return 0;
+}
+
+int stamp_frame(frame_t *frame, uint64_t seq, int64_t sent_us) {
+  char *msg = frame->data + FRAME_HEADER_SIZE;
+  size_t len = frame->size - FRAME_HEADER_SIZE;
+  if (frame->size <= FRAME_HEADER_SIZE || msg[len - 1] != '}') {
+    return EINVAL;
+  }
+
+  // the members go in place of the closing brace
+  int ret = snprintf_werr(msg + len - 1, MSG_MAX - (len - 1),
+                          ",\"seq\":%" PRIu64 ",\"sentAt\":%" PRId64 ".%03d}",
+                          seq, sent_us / 1000, (int)(sent_us % 1000));
+  if (ret != 0) {
+    msg[len - 1] = '}';
+    msg[len] = '\0';
+    return ret;
+  }
+  seal_frame(frame);
+  return 0;
+}
+
+uint32_t frame_body_size(const char *header) {
+  uint32_t len_le;
+  memcpy(&len_le, header, FRAME_HEADER_SIZE);
+  return le32toh(len_le);
+}
+
+int parse_request_type(const char *json, size_t len, char *type,
+                       size_t size) {
+  static const char key[] = "\"type\"";
+  const char *end = json + len;
+  const char *p = memmem(json, len, key, sizeof(key) - 1);
+  if (p == NULL) {
+    return ENOENT;
+  }
+  p += sizeof(key) - 1;
+
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+    p++;
+  }
+  if (p == end || *p++ != ':') {
+    return EINVAL;
+  }
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+    p++;
+  }
+  if (p == end || *p++ != '"') {
+    return EINVAL;
+  }
+
+  size_t n = 0;
+  while (p < end && *p != '"') {
+    if (*p == '\\' || n + 1 >= size) {
+      // no request type needs escaping or is this long
+      return EINVAL;
+    }
+    type[n++] = *p++;
+  }
+  if (p == end) {
+    return EINVAL;
+  }
+  type[n] = '\0';
+  return 0;
+}
+
+int write_all(int fd, const void *buf, size_t len) {
+  const char *p = buf;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+int nonblocking_stdout(void) {
+  int flags = fcntl(STDOUT_FILENO, F_GETFL);
+  if (flags == -1) {
+    return -1;
+  }
+  fcntl(STDOUT_FILENO, F_SETFL, flags | O_NONBLOCK);
+  return flags;
+}
+
+void shrink_stdout_pipe(void) {
+  // fails for anything but a pipe, and then there is no backlog to bound
+  fcntl(STDOUT_FILENO, F_SETPIPE_SZ, (int)sysconf(_SC_PAGESIZE));
+}
+
+void restore_stdout(int flags) {
+  if (flags != -1) {
+    fcntl(STDOUT_FILENO, F_SETFL, flags);
+  }
+}
+
+int read_all(int fd, void *buf, size_t len) {
+  char *p = buf;
+  while (len > 0) {
+    ssize_t n = read(fd, p, len);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    if (n == 0) {
+      return EPIPE;
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
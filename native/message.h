@@ -0,0 +1,88 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_MESSAGE_H
+#define OMARCHY_MESSAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MSG_MAX 1024
+#define FRAME_HEADER_SIZE 4
+// largest request the browser may send, see parse_request_type
+#define REQUEST_MAX 256
+
+// one native messaging message: its length as an unsigned 32-bit value in
+// little-endian byte order, followed by the json
+typedef struct {
+  size_t size; // bytes used in data, header included
+  char data[FRAME_HEADER_SIZE + MSG_MAX];
+} frame_t;
+
+// Write formatted string into s (capacity maxlen).
+// Return 0 on success, ERANGE if truncated, or other errno-style nonzero on
+// error.
+int snprintf_werr(char *s, size_t maxlen, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// parse "r,g,b" with each channel in 0..255. return 0 on success, EINVAL if
+// the string is malformed.
+int parse_rgb(const char *rgb, uint8_t out[3]);
+
+// build the frame for
+// `{ rgb: [number,number,number] | null,
+//    theme?: FirefoxTheme, error: string | null }`
+// where `rgb` is "r,g,b" or NULL, and `err` with strerror(en) becomes the
+// error string when not NULL. returns 0, or errno if it does not fit.
+int format_frame(frame_t *frame, const char *rgb, const char *err, int en);
+
+// build a frame from printf-style json, for replies that carry no theme.
+// returns 0, or errno if it does not fit.
+int format_reply(frame_t *frame, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// add `"seq":seq,"sentAt":ms` to the json object in frame, where ms is
+// sent_us in milliseconds since the epoch with a fractional part, so the
+// browser can order messages and compare the time against Date.now().
+// returns 0, or errno with frame unchanged.
+int stamp_frame(frame_t *frame, uint64_t seq, int64_t sent_us);
+
+// the body length from the FRAME_HEADER_SIZE bytes at `header`
+uint32_t frame_body_size(const char *header);
+
+// copy the string value of the first `"type"` member of a request such as
+// `{"type":"get"}` into type (capacity size). returns 0, ENOENT if there is no
+// such member, or EINVAL if its value is not a short unescaped string.
+int parse_request_type(const char *json, size_t len, char *type,
+                       size_t size);
+
+// 64-bit FNV-1a
+uint64_t hash_bytes(const char *s, size_t len);
+
+// write all `len` bytes, retrying short writes and EINTR. returns 0 or errno.
+int write_all(int fd, const void *buf, size_t len);
+
+// make stdout non-blocking, so a browser that stops reading makes writes fail
+// with EAGAIN instead of stalling the host. returns the previous file status
+// flags for restore_stdout, or -1 if they could not be read.
+int nonblocking_stdout(void);
+
+// shrink stdout to a single page if it is a pipe. whatever sits in the pipe
+// has left the mailbox, so the browser reads and applies all of it before the
+// newest theme: a default 64 KiB pipe holds over a hundred stale themes, a
+// page holds a few.
+void shrink_stdout_pipe(void);
+
+// put back the stdout flags nonblocking_stdout returned. a terminal shares
+// them with the shell, which would otherwise be left non-blocking.
+void restore_stdout(int flags);
+
+// read exactly `len` bytes, retrying short reads and EINTR. returns 0, errno,
+// or EPIPE on end of file.
+int read_all(int fd, void *buf, size_t len);
+
+#endif
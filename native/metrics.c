@@ -0,0 +1,200 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "metrics.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define METRICS_NAME "omarchy-firefox-theme"
+#define PREFIX "omarchy_firefox_theme_"
+
+void histogram_add(histogram_t *h, uint64_t ns) {
+  int i = 0;
+  while (i < LATENCY_BUCKETS && ns > (UINT64_C(1000) << i)) {
+    i++;
+  }
+  h->buckets[i]++;
+  h->count++;
+  h->sum_ns += ns;
+}
+
+// append printf-style output at *off in buf (capacity size). returns 0, or
+// ERANGE once it no longer fits.
+__attribute__((format(printf, 4, 5))) static int
+append(char *buf, size_t size, size_t *off, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf + *off, size - *off, format, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size - *off) {
+    return ERANGE;
+  }
+  *off += (size_t)n;
+  return 0;
+}
+
+int metrics_format_json(char *buf, size_t size, const metrics_t *m) {
+  const watcher_stats_t *w = m->w;
+  size_t off = 0;
+  int ret = append(
+      buf, size, &off,
+      "{\"watcher\":\"%s\",\"events\":%" PRIu64 ",\"polls\":%" PRIu64
+      ",\"coalesced\":%" PRIu64 ",\"suppressed\":%" PRIu64
+      ",\"superseded\":%" PRIu64 ",\"overflows\":%" PRIu64
+      ",\"clients\":%d,\"io\":\"%s\",\"ioSyscalls\":%" PRIu64
+      ",\"reads\":%" PRIu64 ",\"readErrors\":%" PRIu64 ",\"readNs\":%" PRIu64
+      ",\"messages\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"stalls\":%" PRIu64
+      ",\"eventsByMask\":{",
+      m->watcher, w->events, w->polls, m->coalesced, m->suppressed,
+      m->superseded, w->overflows, m->clients, m->io, m->io_syscalls,
+      w->reads, w->read_errors, w->read_ns, m->messages, m->bytes, m->stalls);
+  for (int i = 0; ret == 0 && i < WATCHER_MASKS; i++) {
+    ret = append(buf, size, &off, "%s\"%s\":%" PRIu64, i > 0 ? "," : "",
+                 watcher_masks[i].name, w->by_mask[i]);
+  }
+
+  // buckets past the last one used are left out; bucket i still counts up
+  // to 2^i microseconds
+  int used = LATENCY_BUCKETS + 1;
+  while (used > 0 && m->latency->buckets[used - 1] == 0) {
+    used--;
+  }
+  if (ret == 0) {
+    ret = append(buf, size, &off, "},\"latency\":{\"buckets\":[");
+  }
+  for (int i = 0; ret == 0 && i < used; i++) {
+    ret = append(buf, size, &off, "%s%" PRIu64, i > 0 ? "," : "",
+                 m->latency->buckets[i]);
+  }
+  if (ret == 0) {
+    ret = append(buf, size, &off,
+                 "],\"count\":%" PRIu64 ",\"sumNs\":%" PRIu64 "}}",
+                 m->latency->count, m->latency->sum_ns);
+  }
+  return ret;
+}
+
+int metrics_file_path(char *dst, size_t size, int daemon) {
+  const char *env = getenv(METRICS_ENV);
+  const char *dir = getenv("XDG_RUNTIME_DIR");
+  if (env == NULL || strcmp(env, "1") != 0 || dir == NULL || *dir == '\0') {
+    return ENOENT;
+  }
+  // a host per browser when serving stdout, so each needs a file of its own
+  if (daemon) {
+    return snprintf_werr(dst, size, "%s/" METRICS_NAME ".prom", dir);
+  }
+  return snprintf_werr(dst, size, "%s/" METRICS_NAME ".%d.prom", dir,
+                       (int)getpid());
+}
+
+static void write_counter(FILE *f, const char *name, const char *help,
+                          uint64_t value) {
+  fprintf(f,
+          "# HELP " PREFIX "%s %s\n# TYPE " PREFIX "%s counter\n" PREFIX
+          "%s %" PRIu64 "\n",
+          name, help, name, name, value);
+}
+
+static void write_metrics(FILE *f, const metrics_t *m) {
+  const watcher_stats_t *w = m->w;
+  fprintf(f,
+          "# HELP " PREFIX "info Backends the host picked.\n"
+          "# TYPE " PREFIX "info gauge\n" PREFIX
+          "info{watcher=\"%s\",io=\"%s\"} 1\n",
+          m->watcher, m->io);
+  fprintf(f,
+          "# HELP " PREFIX "clients Clients connected.\n"
+          "# TYPE " PREFIX "clients gauge\n" PREFIX "clients %d\n",
+          m->clients);
+
+  fprintf(f, "# HELP " PREFIX "events_total inotify events read, by mask "
+             "bit.\n# TYPE " PREFIX "events_total counter\n");
+  for (int i = 0; i < WATCHER_MASKS; i++) {
+    fprintf(f, PREFIX "events_total{mask=\"%s\"} %" PRIu64 "\n",
+            watcher_masks[i].name, w->by_mask[i]);
+  }
+  write_counter(f, "polls_total", "Polls made by the polling watcher.",
+                w->polls);
+  write_counter(f, "overflows_total", "inotify queue overflows.",
+                w->overflows);
+  write_counter(f, "coalesced_total",
+                "Theme changes folded into a reload already pending.",
+                m->coalesced);
+  write_counter(f, "suppressed_total",
+                "Messages dropped as identical to the last one sent.",
+                m->suppressed);
+  write_counter(f, "superseded_total",
+                "Messages replaced before a client could take them.",
+                m->superseded);
+  write_counter(f, "reads_total", "chromium.theme reads.", w->reads);
+  write_counter(f, "read_errors_total", "chromium.theme reads that failed.",
+                w->read_errors);
+  fprintf(f,
+          "# HELP " PREFIX "read_seconds_total Time spent reading "
+          "chromium.theme.\n"
+          "# TYPE " PREFIX "read_seconds_total counter\n" PREFIX
+          "read_seconds_total %.9f\n",
+          (double)w->read_ns / 1e9);
+  write_counter(f, "messages_total", "Frames written to clients in full.",
+                m->messages);
+  write_counter(f, "written_bytes_total", "Bytes written to clients.",
+                m->bytes);
+  write_counter(f, "write_stalls_total",
+                "Writes that found a client's pipe or socket full.",
+                m->stalls);
+  write_counter(f, "io_syscalls_total",
+                "Syscalls made for file reads and client writes.",
+                m->io_syscalls);
+
+  fprintf(f, "# HELP " PREFIX "latency_seconds From a theme event to the "
+             "message's write.\n# TYPE " PREFIX "latency_seconds histogram\n");
+  uint64_t cumulative = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    cumulative += m->latency->buckets[i];
+    fprintf(f, PREFIX "latency_seconds_bucket{le=\"%g\"} %" PRIu64 "\n",
+            (double)(UINT64_C(1) << i) / 1e6, cumulative);
+  }
+  fprintf(f,
+          PREFIX "latency_seconds_bucket{le=\"+Inf\"} %" PRIu64 "\n" PREFIX
+                 "latency_seconds_sum %.9f\n" PREFIX
+                 "latency_seconds_count %" PRIu64 "\n",
+          m->latency->count, (double)m->latency->sum_ns / 1e9,
+          m->latency->count);
+}
+
+int metrics_write_file(const char *path, const metrics_t *m) {
+  char tmp[METRICS_PATH_MAX + 8];
+  int ret = snprintf_werr(tmp, sizeof(tmp), "%s.tmp", path);
+  if (ret != 0) {
+    return ret;
+  }
+
+  FILE *f = fopen(tmp, "we");
+  if (f == NULL) {
+    return errno;
+  }
+  write_metrics(f, m);
+  if (ferror(f)) {
+    fclose(f);
+    unlink(tmp);
+    return EIO;
+  }
+  if (fclose(f) != 0 || rename(tmp, path) == -1) {
+    ret = errno;
+    unlink(tmp);
+  }
+  return ret;
+}
@@ -0,0 +1,65 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_METRICS_H
+#define OMARCHY_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "watcher.h"
+
+// "1" has the host keep a Prometheus text file under $XDG_RUNTIME_DIR up to
+// date, for node exporter's textfile collector. see metrics_file_path.
+#define METRICS_ENV "OMARCHY_FIREFOX_THEME_METRICS"
+
+// capacity for metrics_file_path
+#define METRICS_PATH_MAX 256
+
+// bucket i counts latencies up to 2^i microseconds, the last bucket those
+// above that: 1us to about 8s in powers of two
+#define LATENCY_BUCKETS 24
+
+typedef struct {
+  uint64_t buckets[LATENCY_BUCKETS + 1]; // per bucket, not cumulative
+  uint64_t count;
+  uint64_t sum_ns;
+} histogram_t;
+
+// everything the host counts, gathered for a stats reply or the metrics file
+typedef struct {
+  const char *watcher; // watcher_backend
+  const char *io;      // io_backend
+  const watcher_stats_t *w;
+  uint64_t coalesced;
+  uint64_t suppressed;
+  uint64_t superseded;
+  uint64_t messages;    // frames written to clients in full, replies included
+  uint64_t bytes;       // bytes written to clients
+  uint64_t stalls;      // writes that found a client's pipe or socket full
+  uint64_t io_syscalls; // io_stats
+  int clients;
+  const histogram_t *latency; // from a theme event to the message's write
+} metrics_t;
+
+void histogram_add(histogram_t *h, uint64_t ns);
+
+// the body of the stats reply. returns 0, or ERANGE if it does not fit.
+int metrics_format_json(char *buf, size_t size, const metrics_t *m);
+
+// the metrics file for this host when METRICS_ENV asks for one: the
+// daemon's `$XDG_RUNTIME_DIR/omarchy-firefox-theme.prom`, or one named after
+// the pid for a host serving stdout. returns 0, ENOENT if none is wanted or
+// XDG_RUNTIME_DIR is unset, or ERANGE if the path is too long.
+int metrics_file_path(char *dst, size_t size, int daemon);
+
+// replace the file at `path` with the metrics in Prometheus text format,
+// through a rename so a scrape never sees it half written. returns 0 or
+// errno.
+int metrics_write_file(const char *path, const metrics_t *m);
+
+#endif
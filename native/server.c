@@ -0,0 +1,912 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _GNU_SOURCE
+
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "io.h"
+#include "message.h"
+#include "metrics.h"
+#include "trace.h"
+#include "watcher.h"
+
+// the socket is named per build, see build_id
+#define SOCKET_NAME "omarchy-firefox-theme-"
+#define SOCKET_SUFFIX ".sock"
+#define LOCK_SUFFIX ".lock"
+#define MAX_CLIENTS 64
+#define MAX_EVENTS 16
+// how long the daemon stays up without clients, so closing and reopening a
+// browser does not restart it
+#define DAEMON_IDLE_MS 30000
+// how long the watcher waits for the event stream to go quiet before it
+// rereads chromium.theme, overridable through SETTLE_MS_ENV
+#define SETTLE_MS_DEFAULT 50
+#define SETTLE_MS_MAX 5000
+#define SETTLE_MS_ENV "OMARCHY_FIREFOX_THEME_SETTLE_MS"
+// how long a stream of events that never goes quiet may hold back a reload,
+// when that is longer than the settle window. a slideshow still shows a theme
+// this often.
+#define SETTLE_MAX_MS 250
+// how often the metrics file is rewritten at most, see METRICS_ENV
+#define METRICS_INTERVAL_MS 1000
+
+// loop counters, reported on stderr when the host exits and through the
+// stats request
+static struct {
+  uint64_t coalesced;  // theme events folded into a reload already pending
+  uint64_t suppressed; // messages identical to the last one sent, dropped
+  uint64_t superseded; // messages replaced by a newer one before a client
+                       // could take them
+  uint64_t messages;   // frames written to a client in full
+  uint64_t bytes;      // bytes written to clients
+  uint64_t stalls;     // writes that found a client full, see flush_clients
+  histogram_t latency; // from the first event of a change to its write
+} stats;
+
+// theme changes waiting for the event stream to go quiet. times are in
+// milliseconds of CLOCK_MONOTONIC, in run and serve_replay alike.
+typedef struct {
+  int pending;      // changes seen since the last reload
+  int64_t first;    // when the first of them was seen
+  int64_t deadline; // when to reload if no further change arrives
+} settle_t;
+
+// the last message published, sent to clients as they connect
+static frame_t latest;
+static uint64_t latest_hash;
+static uint64_t latest_seq; // numbers every message published, from 1
+
+// what a client is owed but has not been handed yet. each is a single slot
+// that is filled from the current state only once the client can take it, so
+// a client that reads slowly skips stale themes instead of queueing them.
+// requests of one type still waiting for their reply get that one reply.
+#define DUE_THEME 0x1u // `latest`
+#define DUE_PONG 0x2u  // the reply to ping
+#define DUE_STATS 0x4u // the reply to stats
+
+// one reader of theme messages. requests from it are buffered in `req` until
+// a whole frame has arrived, and what it is sent goes out through `out`.
+typedef struct {
+  int in_fd;       // requests arrive here; -1 if the client cannot send any
+  int out_fd;      // messages and replies are written here, non-blocking
+  int out_watched; // whether epoll waits for out_fd to become writable
+  unsigned due;    // DUE_* bits
+  size_t sent;     // bytes of `out` already written
+  frame_t out;     // the frame being written, kept whole so none is torn
+  size_t len;      // bytes used in req
+  char req[FRAME_HEADER_SIZE + REQUEST_MAX];
+} client_t;
+
+// the metrics file, empty unless METRICS_ENV asks for one
+static char metrics_path[METRICS_PATH_MAX];
+
+// stdin/stdout in serve_stdout, accepted connections in serve_socket
+static client_t clients[MAX_CLIENTS];
+static int client_count = 0;
+
+// set by SIGTERM/SIGINT; the loop returns once epoll_wait is interrupted
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int sig) {
+  (void)sig;
+  stop_requested = 1;
+}
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int64_t now_ms(void) { return now_ns() / 1000000; }
+
+// microseconds since the epoch, comparable with the browser's clock
+static int64_t wall_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// settle window in milliseconds from SETTLE_MS_ENV, or SETTLE_MS_DEFAULT if
+// it is unset or not an integer in 0..SETTLE_MS_MAX. 0 only coalesces events
+// that arrive in the same read.
+static int get_settle_ms(void) {
+  const char *env = getenv(SETTLE_MS_ENV);
+  if (env == NULL || *env == '\0') {
+    return SETTLE_MS_DEFAULT;
+  }
+
+  char *end;
+  errno = 0;
+  long v = strtol(env, &end, 10);
+  if (errno != 0 || *end != '\0' || v < 0 || v > SETTLE_MS_MAX) {
+    fprintf(stderr, "ignoring %s='%s', expected 0..%d\n", SETTLE_MS_ENV, env,
+            SETTLE_MS_MAX);
+    return SETTLE_MS_DEFAULT;
+  }
+  return (int)v;
+}
+
+// the longest a run of changes may hold back its reload, for a settle window
+// of `window`
+static int64_t settle_limit(int64_t window) {
+  return window > SETTLE_MAX_MS ? window : SETTLE_MAX_MS;
+}
+
+// note `matched` changes seen at `now`, pushing the reload back to `window`
+// after it, but no further than `limit` after the first change pending
+static void settle_note(settle_t *s, int matched, int64_t now, int64_t window,
+                        int64_t limit) {
+  // one omarchy theme switch can emit several events for `theme`; reread
+  // chromium.theme once after they stop arriving
+  if (s->pending == 0) {
+    s->first = now;
+  }
+  s->pending += matched;
+  s->deadline = now + window;
+  if (s->deadline > s->first + limit) {
+    s->deadline = s->first + limit;
+  }
+}
+
+// whether the changes noted have gone quiet by `now`. if so they are taken as
+// one reload, and all but one count as coalesced.
+static int settle_due(settle_t *s, int64_t now) {
+  if (s->pending == 0 || now < s->deadline) {
+    return 0;
+  }
+  stats.coalesced += (uint64_t)(s->pending - 1);
+  s->pending = 0;
+  return 1;
+}
+
+static void print_stats(void) {
+  const watcher_stats_t *w = watcher_stats();
+  fprintf(stderr,
+          "watcher: %s, events: %" PRIu64 ", polls: %" PRIu64
+          ", coalesced: %" PRIu64 ", suppressed: %" PRIu64
+          ", superseded: %" PRIu64 ", overflows: %" PRIu64
+          ", io: %s, io syscalls: %" PRIu64 "\n",
+          watcher_backend(), w->events, w->polls, stats.coalesced,
+          stats.suppressed, stats.superseded, w->overflows, io_backend(),
+          io_stats()->syscalls);
+}
+
+static void collect_metrics(metrics_t *m) {
+  *m = (metrics_t){
+      .watcher = watcher_backend(),
+      .io = io_backend(),
+      .w = watcher_stats(),
+      .coalesced = stats.coalesced,
+      .suppressed = stats.suppressed,
+      .superseded = stats.superseded,
+      .messages = stats.messages,
+      .bytes = stats.bytes,
+      .stalls = stats.stalls,
+      .io_syscalls = io_stats()->syscalls,
+      .clients = client_count,
+      .latency = &stats.latency,
+  };
+}
+
+// rewrite the metrics file, if there is one. after a failure, which is
+// reported, it is left alone.
+static void update_metrics_file(void) {
+  if (metrics_path[0] == '\0') {
+    return;
+  }
+  metrics_t m;
+  collect_metrics(&m);
+  int ret = metrics_write_file(metrics_path, &m);
+  if (ret != 0) {
+    fprintf(stderr, "could not write '%s': %s\n", metrics_path, strerror(ret));
+    metrics_path[0] = '\0';
+  }
+}
+
+// returns the index of the client reading from or writing to `fd`, or -1
+static int find_client(int fd) {
+  for (int i = 0; i < client_count; i++) {
+    if (clients[i].in_fd == fd || clients[i].out_fd == fd) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// have epoll report when client `c` can be written to, or stop it
+static void watch_output(int epoll_fd, client_t *c, int want) {
+  if (want == c->out_watched) {
+    return;
+  }
+
+  struct epoll_event ev = {.data.fd = c->out_fd};
+  int ret;
+  if (c->out_fd == c->in_fd) {
+    ev.events = EPOLLIN | (want ? EPOLLOUT : 0);
+    ret = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, c->out_fd, &ev);
+  } else {
+    ev.events = EPOLLOUT;
+    ret = epoll_ctl(epoll_fd, want ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, c->out_fd,
+                    &ev);
+  }
+  // a file or /dev/null on stdout cannot be watched, but never blocks either
+  if (ret == 0) {
+    c->out_watched = want;
+  }
+}
+
+// stop watching client `i` and close it, unless it is stdin/stdout
+static void drop_client(int epoll_fd, int i) {
+  client_t *c = &clients[i];
+  if (c->in_fd >= 0) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->in_fd, NULL);
+  }
+  if (c->out_watched && c->out_fd != c->in_fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->out_fd, NULL);
+  }
+  if (c->out_fd != STDOUT_FILENO) {
+    close(c->out_fd);
+  }
+  *c = clients[--client_count];
+}
+
+// move the next frame client `c` is owed into its `out`. returns 0 once it
+// is owed nothing.
+static int next_output(client_t *c) {
+  while (c->due != 0) {
+    int ret = 0;
+    if (c->due & DUE_PONG) {
+      c->due &= ~DUE_PONG;
+      ret = format_reply(&c->out, "{\"type\":\"pong\"}");
+    } else if (c->due & DUE_STATS) {
+      c->due &= ~DUE_STATS;
+      metrics_t m;
+      collect_metrics(&m);
+      char body[MSG_MAX];
+      ret = metrics_format_json(body, sizeof(body), &m);
+      if (ret == 0) {
+        ret = format_reply(&c->out, "{\"type\":\"stats\",\"stats\":%s}",
+                           body);
+      }
+    } else {
+      c->due &= ~DUE_THEME;
+      if (latest.size == 0) {
+        continue;
+      }
+      memcpy(c->out.data, latest.data, latest.size);
+      c->out.size = latest.size;
+    }
+
+    if (ret != 0) {
+      fprintf(stderr, "could not format reply: %s\n", strerror(ret));
+      continue;
+    }
+    c->sent = 0;
+    return 1;
+  }
+  return 0;
+}
+
+// write what clients are owed until they take no more without blocking:
+// client `only`, or every client if it is -1. each round hands the next piece
+// for every client to io_write_batch at once. a client is dropped if writing
+// to it fails, and waited on through epoll if anything is left.
+static void flush_clients(int epoll_fd, int only) {
+  int lo = only < 0 ? 0 : only;
+  int hi = only < 0 ? client_count : only + 1;
+  int done[MAX_CLIENTS] = {0}; // nothing left, or it would block
+  int failed[MAX_CLIENTS] = {0};
+
+  while (1) {
+    io_write_t writes[MAX_CLIENTS];
+    int idx[MAX_CLIENTS];
+    int n = 0;
+    for (int i = lo; i < hi; i++) {
+      client_t *c = &clients[i];
+      if (done[i] || (c->sent == c->out.size && !next_output(c))) {
+        done[i] = 1;
+        continue;
+      }
+      writes[n] = (io_write_t){.fd = c->out_fd,
+                               .buf = c->out.data + c->sent,
+                               .len = c->out.size - c->sent};
+      idx[n++] = i;
+    }
+    if (n == 0) {
+      break;
+    }
+
+    io_write_batch(writes, n);
+    for (int k = 0; k < n; k++) {
+      int i = idx[k];
+      ssize_t r = writes[k].result;
+      if (r >= 0) {
+        clients[i].sent += (size_t)r;
+        stats.bytes += (uint64_t)r;
+        if (clients[i].sent == clients[i].out.size) {
+          stats.messages++;
+        }
+      } else if (r == -EAGAIN) {
+        // the client is not keeping up; the rest waits for epoll
+        stats.stalls++;
+        done[i] = 1;
+      } else if (r != -EINTR) {
+        failed[i] = (int)-r;
+        done[i] = 1;
+      }
+    }
+  }
+
+  // backwards, so drop_client's swap with the last slot skips nothing
+  for (int i = hi - 1; i >= lo; i--) {
+    client_t *c = &clients[i];
+    if (failed[i] != 0) {
+      fprintf(stderr, "could not send message: %s\n", strerror(failed[i]));
+      drop_client(epoll_fd, i);
+      continue;
+    }
+    watch_output(epoll_fd, c, c->sent < c->out.size || c->due != 0);
+  }
+}
+
+// hand `latest` to every client, replacing any older theme still waiting
+static void send_latest(int epoll_fd) {
+  for (int i = 0; i < client_count; i++) {
+    if (clients[i].due & DUE_THEME) {
+      stats.superseded++;
+    }
+    clients[i].due |= DUE_THEME;
+  }
+  flush_clients(epoll_fd, -1);
+}
+
+// send `frame` to every client, unless it is identical to the last one sent.
+// returns whether it was sent.
+static int publish(int epoll_fd, const frame_t *frame) {
+  uint64_t hash = hash_bytes(frame->data, frame->size);
+  if (latest.size != 0 && hash == latest_hash) {
+    stats.suppressed++;
+    return 0;
+  }
+  latest = *frame;
+  latest_hash = hash;
+  trace_write(TRACE_MESSAGE, 0, (uint32_t)frame->size, &hash, sizeof(hash));
+  // stamped after hashing, so an unchanged theme is still a duplicate; a
+  // message too long to stamp goes out without
+  stamp_frame(&latest, ++latest_seq, wall_us());
+  send_latest(epoll_fd);
+  return 1;
+}
+
+// publish the error `what`: `en`, falling back to stderr if even that cannot
+// be formatted
+static void publish_error(int epoll_fd, const char *what, int en) {
+  frame_t frame;
+  if (format_frame(&frame, NULL, what, en) != 0) {
+    fprintf(stderr, "%s: %s\n", what, strerror(en));
+    return;
+  }
+  publish(epoll_fd, &frame);
+}
+
+static void accept_clients(int epoll_fd, int listen_fd) {
+  while (1) {
+    int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // EAGAIN once the backlog is drained
+      return;
+    }
+
+    struct epoll_event ev = {.events = EPOLLIN, .data.fd = fd};
+    if (client_count == MAX_CLIENTS ||
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+      close(fd);
+      continue;
+    }
+    clients[client_count++] =
+        (client_t){.in_fd = fd, .out_fd = fd, .due = DUE_THEME};
+    flush_clients(epoll_fd, client_count - 1);
+  }
+}
+
+// note what request `json` asks of client `c`; flush_clients sends it
+static void handle_request(client_t *c, const char *json, size_t len) {
+  char type[16];
+  if (parse_request_type(json, len, type, sizeof(type)) != 0) {
+    // `{}` and the like carry nothing to answer
+    return;
+  }
+
+  if (strcmp(type, "get") == 0) {
+    // the latest message again, even though it is unchanged
+    c->due |= DUE_THEME;
+  } else if (strcmp(type, "ping") == 0) {
+    c->due |= DUE_PONG;
+  } else if (strcmp(type, "stats") == 0) {
+    c->due |= DUE_STATS;
+  } else {
+    fprintf(stderr, "ignoring unknown request '%s'\n", type);
+  }
+}
+
+// read what client `c` sent and take in every complete request in it.
+// returns 0, or errno if the client hung up or sent something malformed.
+static int read_requests(client_t *c) {
+  ssize_t n = read(c->in_fd, c->req + c->len, sizeof(c->req) - c->len);
+  if (n == -1) {
+    return errno == EAGAIN || errno == EINTR ? 0 : errno;
+  }
+  if (n == 0) {
+    return EPIPE;
+  }
+  c->len += (size_t)n;
+
+  while (c->len >= FRAME_HEADER_SIZE) {
+    uint32_t len = frame_body_size(c->req);
+    if (len > REQUEST_MAX) {
+      fprintf(stderr, "request of %" PRIu32 " bytes is too long\n", len);
+      return EMSGSIZE;
+    }
+    size_t size = FRAME_HEADER_SIZE + len;
+    if (c->len < size) {
+      break;
+    }
+
+    handle_request(c, c->req + FRAME_HEADER_SIZE, len);
+    c->len -= size;
+    memmove(c->req, c->req + size, c->len);
+  }
+  return 0;
+}
+
+// handle epoll `events` on `fd`: requests from a client, or room to write
+// to it. drops the client once it hangs up or sends something malformed.
+static void service_client(int epoll_fd, int fd, uint32_t events) {
+  int i = find_client(fd);
+  if (i == -1) {
+    return;
+  }
+
+  client_t *c = &clients[i];
+  if (fd == c->in_fd) {
+    int ret = 0;
+    if (events & EPOLLIN) {
+      ret = read_requests(c);
+    } else if (events & (EPOLLHUP | EPOLLERR)) {
+      ret = EPIPE;
+    }
+    if (ret != 0) {
+      drop_client(epoll_fd, i);
+      return;
+    }
+  }
+  // replies to new requests, or the rest of what stdout or the socket could
+  // not take before; a broken pipe shows up here as EPIPE
+  flush_clients(epoll_fd, i);
+}
+
+// the shared event loop. `listen_fd` is -1 when stdout is the only client.
+// returns 0 when stopped or idle, or errno if the watcher failed.
+static int run(int listen_fd) {
+  io_open();
+  // a trace that cannot be written is reported, but watching goes on
+  trace_start();
+
+  const char *what = NULL;
+  int ret = watcher_open(&what);
+  if (ret != 0) {
+    publish_error(-1, what, ret);
+    trace_stop();
+    io_close();
+    return ret;
+  }
+
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1) {
+    ret = errno;
+    publish_error(-1, "could not init epoll", ret);
+    watcher_close();
+    trace_stop();
+    io_close();
+    return ret;
+  }
+
+  struct epoll_event ev = {.events = EPOLLIN, .data.fd = watcher_fd()};
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, watcher_fd(), &ev);
+  if (listen_fd >= 0) {
+    ev.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+  }
+  for (int i = 0; i < client_count; i++) {
+    ev.data.fd = clients[i].in_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, clients[i].in_fd, &ev) == -1) {
+      // stdin is a file or /dev/null: no requests, and no end of file to
+      // notice, so the host runs until writing stdout fails
+      clients[i].in_fd = -1;
+    }
+  }
+
+  // clients that go away are noticed through EPIPE instead
+  signal(SIGPIPE, SIG_IGN);
+
+  // no SA_RESTART, so a pending epoll_wait returns EINTR
+  struct sigaction sa = {.sa_handler = request_stop};
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGINT, &sa, NULL);
+
+  frame_t frame;
+  if (watcher_format(&frame) == 0) {
+    publish(epoll_fd, &frame);
+  }
+
+  int settle_ms = get_settle_ms();
+  int64_t settle_max = settle_limit(settle_ms);
+  settle_t settle = {0};
+  int64_t change_ns = 0; // when the change being settled was first seen
+  int64_t idle_deadline = now_ms() + DAEMON_IDLE_MS;
+
+  if (metrics_file_path(metrics_path, sizeof(metrics_path), listen_fd >= 0) !=
+      0) {
+    metrics_path[0] = '\0';
+  }
+  update_metrics_file();
+  // rewritten after a counter changed, at most every METRICS_INTERVAL_MS. a
+  // poll tick that finds nothing new does not count: its polls and syscalls
+  // go out with the next write.
+  int metrics_dirty = 0;
+  int64_t metrics_due = now_ms() + METRICS_INTERVAL_MS;
+
+  while (!stop_requested) {
+    int64_t now = now_ms();
+    int timeout = -1;
+    if (settle.pending > 0) {
+      timeout = settle.deadline > now ? (int)(settle.deadline - now) : 0;
+    }
+    if (listen_fd >= 0 && client_count == 0) {
+      int idle = idle_deadline > now ? (int)(idle_deadline - now) : 0;
+      timeout = timeout < 0 || idle < timeout ? idle : timeout;
+    }
+    if (metrics_dirty) {
+      int due = metrics_due > now ? (int)(metrics_due - now) : 0;
+      timeout = timeout < 0 || due < timeout ? due : timeout;
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+    int changed = 0; // whether anything in metrics_t moved this round
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ret = errno;
+      publish_error(epoll_fd, "could not wait for events", ret);
+      break;
+    }
+
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if (fd == watcher_fd()) {
+        int matched = watcher_read();
+        if (matched == -1) {
+          ret = errno;
+          break;
+        }
+        if (matched > 0) {
+          changed = 1;
+          int64_t t = now_ns();
+          if (settle.pending == 0) {
+            change_ns = t;
+          }
+          settle_note(&settle, matched, t / 1000000, settle_ms, settle_max);
+        }
+      } else if (fd == listen_fd) {
+        accept_clients(epoll_fd, listen_fd);
+        changed = 1;
+      } else {
+        service_client(epoll_fd, fd, events[i].events);
+        changed = 1;
+      }
+    }
+    if (ret != 0) {
+      publish_error(epoll_fd, "could not read inotify instance", ret);
+      break;
+    }
+
+    now = now_ms();
+    if (settle_due(&settle, now)) {
+      changed = 1;
+      if (watcher_format(&frame) == 0 && publish(epoll_fd, &frame)) {
+        histogram_add(&stats.latency, (uint64_t)(now_ns() - change_ns));
+      }
+    }
+    if (changed && metrics_path[0] != '\0') {
+      metrics_dirty = 1;
+    }
+    if (metrics_dirty && now >= metrics_due) {
+      update_metrics_file();
+      metrics_dirty = 0;
+      metrics_due = now + METRICS_INTERVAL_MS;
+    }
+    if (client_count > 0) {
+      // clients are dropped while reading and while writing alike; idle time
+      // counts from the last moment there was one
+      idle_deadline = now + DAEMON_IDLE_MS;
+    } else if (listen_fd < 0 || now >= idle_deadline) {
+      // the browser closed stdin or stdout, or the daemon has been idle long
+      // enough
+      break;
+    }
+  }
+
+  while (client_count > 0) {
+    drop_client(epoll_fd, client_count - 1);
+  }
+  close(epoll_fd);
+  watcher_close();
+  print_stats();
+  if (metrics_path[0] != '\0') {
+    // nothing is left to update it
+    unlink(metrics_path);
+  }
+  trace_stop();
+  io_close();
+  return ret;
+}
+
+// this build, told apart by the binary's file. an upgrade replaces that file,
+// so a daemon still running from the previous package keeps its own socket
+// and lock, and shims of the new one start a daemon of their own instead of
+// talking to the old binary.
+static uint64_t build_id(void) {
+  struct stat st;
+  if (stat("/proc/self/exe", &st) == -1) {
+    return 0;
+  }
+  uint64_t id[] = {(uint64_t)st.st_dev, (uint64_t)st.st_ino,
+                   (uint64_t)st.st_size, (uint64_t)st.st_mtim.tv_sec,
+                   (uint64_t)st.st_mtim.tv_nsec};
+  return hash_bytes((const char *)id, sizeof(id));
+}
+
+int server_socket_path(char *dst, size_t size) {
+  const char *dir = getenv("XDG_RUNTIME_DIR");
+  if (dir == NULL || *dir == '\0') {
+    return ENOENT;
+  }
+  if (size > sizeof(((struct sockaddr_un *)0)->sun_path)) {
+    size = sizeof(((struct sockaddr_un *)0)->sun_path);
+  }
+  return snprintf_werr(dst, size, "%s/" SOCKET_NAME "%016" PRIx64 SOCKET_SUFFIX,
+                       dir, build_id());
+}
+
+int serve_stdout(void) {
+  // a browser that stops reading must not stall the watcher, nor find a
+  // backlog of stale themes once it reads again
+  int flags = nonblocking_stdout();
+  shrink_stdout_pipe();
+  clients[client_count++] =
+      (client_t){.in_fd = STDIN_FILENO, .out_fd = STDOUT_FILENO};
+  int ret = run(-1);
+  restore_stdout(flags);
+  return ret;
+}
+
+int serve_socket(void) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  int ret = server_socket_path(addr.sun_path, sizeof(addr.sun_path));
+  if (ret != 0) {
+    fprintf(stderr, "could not get socket path: %s\n", strerror(ret));
+    return ret;
+  }
+
+  char lock_path[sizeof(addr.sun_path) + sizeof(LOCK_SUFFIX)];
+  snprintf(lock_path, sizeof(lock_path), "%s" LOCK_SUFFIX, addr.sun_path);
+
+  // the lock, not the socket file, decides which daemon runs: a socket left
+  // behind by a crashed daemon is replaced, a live one is left alone
+  int lock_fd = open(lock_path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (lock_fd == -1) {
+    ret = errno;
+    fprintf(stderr, "could not open '%s': %s\n", lock_path, strerror(ret));
+    return ret;
+  }
+  if (flock(lock_fd, LOCK_EX | LOCK_NB) == -1) {
+    ret = errno == EWOULDBLOCK ? 0 : errno;
+    close(lock_fd);
+    return ret;
+  }
+
+  unlink(addr.sun_path);
+  int listen_fd =
+      socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd == -1 ||
+      bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+      listen(listen_fd, MAX_CLIENTS) == -1) {
+    ret = errno;
+    fprintf(stderr, "could not listen on '%s': %s\n", addr.sun_path,
+            strerror(ret));
+    if (listen_fd >= 0) {
+      close(listen_fd);
+    }
+    close(lock_fd);
+    return ret;
+  }
+
+  ret = run(listen_fd);
+
+  // unlink while still holding the lock, so a new daemon's socket is never
+  // removed by this one
+  unlink(addr.sun_path);
+  close(listen_fd);
+  close(lock_fd);
+  return ret;
+}
+
+// a message, recorded or replayed
+typedef struct {
+  uint64_t ns;
+  uint32_t size;
+  uint64_t hash;
+} replay_message_t;
+
+// the TRACE_READ that shows chromium.theme as of `ns`: the first the host
+// made at or after it, or its last one if it made none later. NULL if the
+// trace has none. reads before *from are skipped, and *from is advanced,
+// since `ns` only grows from call to call.
+static const trace_record_t *read_as_of(const trace_record_t *r, size_t count,
+                                        size_t *from, uint64_t ns) {
+  const trace_record_t *last = NULL;
+  for (size_t i = *from; i < count; i++) {
+    if (r[i].h.kind != TRACE_READ) {
+      continue;
+    }
+    last = &r[i];
+    if (r[i].h.ns >= ns) {
+      *from = i;
+      return last;
+    }
+  }
+  // every later call ends up here too
+  return last;
+}
+
+// reload at `ns` from the read in effect then, and note the message if one
+// is sent
+static void replay_reload(const trace_record_t *r, size_t count,
+                          size_t *read_from, uint64_t ns,
+                          replay_message_t *out, size_t *n) {
+  const trace_record_t *read = read_as_of(r, count, read_from, ns);
+  frame_t frame;
+  if (read == NULL || watcher_replay_format(&frame, read) != 0 ||
+      !publish(-1, &frame)) {
+    return;
+  }
+  out[(*n)++] = (replay_message_t){.ns = ns,
+                                   .size = (uint32_t)frame.size,
+                                   .hash = latest_hash};
+}
+
+static void print_message(const replay_message_t *m, size_t n, size_t i,
+                          uint64_t start) {
+  if (i >= n) {
+    printf(" %12s %6s %16s", "-", "-", "-");
+    return;
+  }
+  printf(" %12.3f %6" PRIu32 " %016" PRIx64,
+         (double)(m[i].ns - start) / 1e6, m[i].size, m[i].hash);
+}
+
+int serve_replay(const char *path) {
+  trace_record_t *r;
+  size_t count;
+  int ret = trace_load(path, &r, &count);
+  if (ret != 0) {
+    fprintf(stderr, "could not load trace '%s': %s\n", path, strerror(ret));
+    return ret;
+  }
+
+  // no trace sends more messages than it has records
+  replay_message_t *recorded = calloc(count + 1, sizeof(*recorded));
+  replay_message_t *replayed = calloc(count + 1, sizeof(*replayed));
+  if (recorded == NULL || replayed == NULL) {
+    free(recorded);
+    free(replayed);
+    trace_free(r);
+    return ENOMEM;
+  }
+  size_t n_recorded = 0, n_replayed = 0, read_from = 0;
+  uint64_t start = count > 0 ? r[0].h.ns : 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (r[i].h.kind == TRACE_MESSAGE && r[i].h.len == sizeof(uint64_t)) {
+      recorded[n_recorded].ns = r[i].h.ns;
+      recorded[n_recorded].size = r[i].h.value;
+      memcpy(&recorded[n_recorded++].hash, r[i].data, sizeof(uint64_t));
+    }
+  }
+
+  // what run does, on the trace's clock: the first message as the host
+  // starts, then one reload once each run of events settles. run settles in
+  // whole milliseconds of the same clock, so this does too: an exact
+  // deadline can fall after the read run made for it.
+  int64_t window = get_settle_ms();
+  int64_t limit = settle_limit(window);
+  settle_t settle = {0};
+  replay_reload(r, count, &read_from, start, replayed, &n_replayed);
+  for (size_t i = 0; i < count;) {
+    if (r[i].h.kind != TRACE_WATCHES) {
+      i++;
+      continue;
+    }
+    int64_t ms = (int64_t)(r[i].h.ns / 1000000);
+    if (settle_due(&settle, ms)) {
+      // the window ran out before this batch arrived
+      replay_reload(r, count, &read_from, (uint64_t)settle.deadline * 1000000,
+                    replayed, &n_replayed);
+    }
+
+    size_t end = i + 1;
+    while (end < count && r[end].h.kind == TRACE_EVENT) {
+      end++;
+    }
+    int matched = watcher_replay_events(r[i].h.aux, r + i + 1, end - i - 1);
+    if (matched > 0) {
+      settle_note(&settle, matched, ms, window, limit);
+    }
+    i = end;
+  }
+  if (settle_due(&settle, settle.deadline)) {
+    replay_reload(r, count, &read_from, (uint64_t)settle.deadline * 1000000,
+                  replayed, &n_replayed);
+  }
+
+  size_t differ = 0;
+  size_t rows = n_recorded > n_replayed ? n_recorded : n_replayed;
+  printf("%5s %12s %6s %16s %12s %6s %16s\n", "#", "recorded ms", "size",
+         "hash", "replayed ms", "size", "hash");
+  for (size_t i = 0; i < rows; i++) {
+    int same = i < n_recorded && i < n_replayed &&
+               recorded[i].hash == replayed[i].hash;
+    differ += !same;
+    printf("%5zu", i);
+    print_message(recorded, n_recorded, i, start);
+    print_message(replayed, n_replayed, i, start);
+    printf("%s\n", same ? "" : "  differs");
+  }
+  printf("%zu records, %zu messages recorded, %zu replayed, %zu differ\n",
+         count, n_recorded, n_replayed, differ);
+  print_stats();
+
+  free(recorded);
+  free(replayed);
+  trace_free(r);
+  return 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_SERVER_H
+#define OMARCHY_SERVER_H
+
+#include <stddef.h>
+
+// argv[1] that starts the host as the shared daemon, see serve_socket
+#define DAEMON_FLAG "--daemon"
+
+// writes `$XDG_RUNTIME_DIR/omarchy-firefox-theme-<build>.sock` into dst,
+// where <build> tells this binary apart from other builds and installs of it.
+// returns 0, ENOENT if XDG_RUNTIME_DIR is unset, or ERANGE if the path is too
+// long for a unix socket address.
+int server_socket_path(char *dst, size_t size);
+
+// watch the omarchy theme in this process, write every change to stdout and
+// answer the requests read from stdin, until the browser closes either or a
+// signal stops the host. returns 0 or errno.
+int serve_stdout(void);
+
+// run the single per-user watcher, sending every change to each client of
+// the socket at server_socket_path and answering each client's requests.
+// returns 0 right away if another daemon holds the socket, and exits once it
+// has had no clients for a while.
+int serve_socket(void);
+
+// replay the trace at `path`, recorded by a host run with TRACE_ENV set, on
+// the trace's own clock and without a filesystem: its inotify events go
+// through the watcher's event parsing and the settle window, chromium.theme
+// reads come from the trace, and the messages that yields are listed on
+// stdout next to the ones recorded. traces of the polling backend hold no
+// events, only reads and messages. returns 0 or errno.
+int serve_replay(const char *path);
+
+#endif
@@ -0,0 +1,328 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "shim.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "message.h"
+#include "server.h"
+
+// how long to wait for a freshly spawned daemon to accept connections
+#define CONNECT_TIMEOUT_MS 1000
+#define CONNECT_RETRY_MS 5
+// daemon connections in a row that end before a single message arrives,
+// after which the shim stops relying on the daemon
+#define MAX_EMPTY_CONNECTIONS 3
+// replies held for a browser that is not reading stdout
+#define MAX_REPLIES 4
+
+static void sleep_ms(long ms) {
+  struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000};
+  while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+  }
+}
+
+// returns a connected socket, or -1 with errno set
+static int connect_daemon(const struct sockaddr_un *addr) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    return -1;
+  }
+  if (connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) == -1) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  return fd;
+}
+
+// start `this binary --daemon` detached from the browser: in its own session,
+// with stdio on /dev/null, and reparented to init so it is never our zombie.
+// returns 0 or errno.
+static int spawn_daemon(void) {
+  // the resolved path, so the daemon shows up under its own name
+  char exe[PATH_MAX];
+  ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  if (len == -1) {
+    return errno;
+  }
+  exe[len] = '\0';
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    return errno;
+  }
+
+  if (pid == 0) {
+    setsid();
+    if (fork() != 0) {
+      _exit(0);
+    }
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+      dup2(null_fd, STDIN_FILENO);
+      dup2(null_fd, STDOUT_FILENO);
+      dup2(null_fd, STDERR_FILENO);
+      if (null_fd > STDERR_FILENO) {
+        close(null_fd);
+      }
+    }
+    execl(exe, exe, DAEMON_FLAG, (char *)NULL);
+    _exit(127);
+  }
+
+  while (waitpid(pid, NULL, 0) == -1 && errno == EINTR) {
+  }
+  return 0;
+}
+
+// connect to the running daemon, starting one if there is none. returns a
+// connected socket, or -1 with errno set.
+static int open_daemon(const struct sockaddr_un *addr) {
+  int fd = connect_daemon(addr);
+  if (fd >= 0 || (errno != ENOENT && errno != ECONNREFUSED)) {
+    return fd;
+  }
+
+  int ret = spawn_daemon();
+  if (ret != 0) {
+    errno = ret;
+    return -1;
+  }
+
+  for (int waited = 0; waited < CONNECT_TIMEOUT_MS;
+       waited += CONNECT_RETRY_MS) {
+    sleep_ms(CONNECT_RETRY_MS);
+    fd = connect_daemon(addr);
+    if (fd >= 0 || (errno != ENOENT && errno != ECONNREFUSED)) {
+      return fd;
+    }
+  }
+  errno = ETIMEDOUT;
+  return -1;
+}
+
+// read one whole frame from `fd` into frame, refusing bodies over `max`.
+// returns 0, errno, or EPIPE on end of file.
+static int read_frame(int fd, frame_t *frame, uint32_t max) {
+  int ret = read_all(fd, frame->data, FRAME_HEADER_SIZE);
+  if (ret != 0) {
+    return ret;
+  }
+  uint32_t len = frame_body_size(frame->data);
+  if (len > max) {
+    return EMSGSIZE;
+  }
+  ret = read_all(fd, frame->data + FRAME_HEADER_SIZE, len);
+  if (ret != 0) {
+    return ret;
+  }
+  frame->size = FRAME_HEADER_SIZE + len;
+  return 0;
+}
+
+// what the shim owes the browser. the newest theme replaces any theme still
+// waiting, so a browser that reads slowly only gets the latest, while replies
+// to its requests are all kept, in order. kept across daemon connections so a
+// frame cut off by a reconnect is still finished.
+static struct {
+  frame_t out; // the frame being written to stdout
+  size_t sent; // bytes of `out` already written
+  frame_t theme;
+  int theme_due;
+  frame_t replies[MAX_REPLIES];
+  int reply_head;
+  int reply_count;
+} outbox;
+
+// queue `frame` from the daemon for stdout
+static void post_frame(const frame_t *frame) {
+  static const char reply_prefix[] = "{\"type\":";
+  int is_reply = frame->size >= FRAME_HEADER_SIZE + sizeof(reply_prefix) - 1 &&
+                 memcmp(frame->data + FRAME_HEADER_SIZE, reply_prefix,
+                        sizeof(reply_prefix) - 1) == 0;
+  if (!is_reply) {
+    outbox.theme = *frame;
+    outbox.theme_due = 1;
+    return;
+  }
+
+  if (outbox.reply_count == MAX_REPLIES) {
+    // a browser this far behind has given up on the oldest reply already
+    outbox.reply_head = (outbox.reply_head + 1) % MAX_REPLIES;
+    outbox.reply_count--;
+  }
+  int tail = (outbox.reply_head + outbox.reply_count) % MAX_REPLIES;
+  outbox.replies[tail] = *frame;
+  outbox.reply_count++;
+}
+
+// move the next frame owed into outbox.out. returns 0 if there is none.
+static int next_output(void) {
+  if (outbox.reply_count > 0) {
+    outbox.out = outbox.replies[outbox.reply_head];
+    outbox.reply_head = (outbox.reply_head + 1) % MAX_REPLIES;
+    outbox.reply_count--;
+  } else if (outbox.theme_due) {
+    outbox.out = outbox.theme;
+    outbox.theme_due = 0;
+  } else {
+    return 0;
+  }
+  outbox.sent = 0;
+  return 1;
+}
+
+// write what stdout takes without blocking. returns 0, or errno if stdout
+// failed.
+static int flush_output(void) {
+  while (outbox.sent < outbox.out.size || next_output()) {
+    ssize_t n = write(STDOUT_FILENO, outbox.out.data + outbox.sent,
+                      outbox.out.size - outbox.sent);
+    if (n == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN ? 0 : errno;
+    }
+    outbox.sent += (size_t)n;
+  }
+  return 0;
+}
+
+static int output_pending(void) {
+  return outbox.sent < outbox.out.size || outbox.reply_count > 0 ||
+         outbox.theme_due;
+}
+
+// copy whole frames from the daemon to stdout, and requests from stdin to the
+// daemon, counting the frames relayed into *relayed. only complete frames are
+// written, so the browser never sees a torn message if the daemon dies
+// mid-write, and stdout is only written when it has room, so a browser that
+// stops reading never stops the shim from draining the daemon. returns -1
+// once the daemon connection ends, 0 once the browser closes stdin, or errno
+// if stdin or stdout failed.
+static int relay(int fd, int *relayed) {
+  struct pollfd fds[3] = {{.fd = STDIN_FILENO, .events = POLLIN},
+                          {.fd = fd, .events = POLLIN},
+                          {.fd = STDOUT_FILENO, .events = POLLOUT}};
+  frame_t frame;
+  while (1) {
+    // a negative fd is skipped by poll
+    fds[2].fd = output_pending() ? STDOUT_FILENO : -1;
+    if (poll(fds, 3, -1) == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+
+    if (fds[0].revents != 0) {
+      int ret = read_frame(STDIN_FILENO, &frame, REQUEST_MAX);
+      if (ret != 0) {
+        return ret == EPIPE ? 0 : ret;
+      }
+      if (write_all(fd, frame.data, frame.size) != 0) {
+        return -1;
+      }
+    }
+
+    if (fds[1].revents != 0) {
+      if (read_frame(fd, &frame, MSG_MAX) != 0) {
+        return -1;
+      }
+      post_frame(&frame);
+      (*relayed)++;
+    }
+
+    int ret = flush_output();
+    if (ret != 0) {
+      return ret;
+    }
+  }
+}
+
+// write the rest of a frame cut off mid-write, blocking, so the next writer
+// of stdout starts on a frame boundary. returns 0 or errno.
+static int finish_output(void) {
+  int flags = fcntl(STDOUT_FILENO, F_GETFL);
+  if (flags != -1) {
+    fcntl(STDOUT_FILENO, F_SETFL, flags & ~O_NONBLOCK);
+  }
+  int ret = write_all(STDOUT_FILENO, outbox.out.data + outbox.sent,
+                      outbox.out.size - outbox.sent);
+  outbox.sent = outbox.out.size;
+  return ret;
+}
+
+// watch in this process instead, once the frame being relayed is finished
+static int watch_in_process(void) {
+  int ret = finish_output();
+  return ret != 0 ? ret : serve_stdout();
+}
+
+static int relay_daemon(const struct sockaddr_un *addr) {
+  // a daemon that exits (idle timeout racing a new client, or a crash) is
+  // replaced; only when none can be reached, or it keeps hanging up right
+  // away, does the shim watch by itself
+  int empty = 0;
+  while (empty < MAX_EMPTY_CONNECTIONS) {
+    int fd = open_daemon(addr);
+    if (fd == -1) {
+      fprintf(stderr, "could not reach daemon, watching in-process: %s\n",
+              strerror(errno));
+      return watch_in_process();
+    }
+
+    int relayed = 0;
+    int ret = relay(fd, &relayed);
+    close(fd);
+    if (ret != -1) {
+      // the browser closed stdin, or stdio failed: either way it is gone
+      return ret;
+    }
+    empty = relayed > 0 ? 0 : empty + 1;
+  }
+
+  fprintf(stderr, "daemon keeps closing the connection, watching in-process\n");
+  return watch_in_process();
+}
+
+int run_shim(void) {
+  struct sockaddr_un addr = {.sun_family = AF_UNIX};
+  int ret = server_socket_path(addr.sun_path, sizeof(addr.sun_path));
+  if (ret != 0) {
+    return serve_stdout();
+  }
+
+  // a daemon that went away is noticed through EPIPE instead
+  signal(SIGPIPE, SIG_IGN);
+
+  // a browser that stops reading must not stop the shim from draining the
+  // daemon, nor find a backlog of stale themes once it reads again
+  int flags = nonblocking_stdout();
+  shrink_stdout_pipe();
+  ret = relay_daemon(&addr);
+  restore_stdout(flags);
+  return ret;
+}
@@ -0,0 +1,17 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_SHIM_H
+#define OMARCHY_SHIM_H
+
+// relay messages from the shared daemon to stdout and requests from stdin to
+// the daemon, starting the daemon if none is running, until the browser
+// closes stdin. falls back to serve_stdout when no daemon can be reached.
+// returns 0 or errno.
+int run_shim(void);
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "trace.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// buffered, since a storm of events would otherwise cost a write each;
+// flushed after every message so a killed host loses little
+static FILE *trace_file = NULL;
+
+int trace_start(void) {
+  const char *path = getenv(TRACE_ENV);
+  if (path == NULL || *path == '\0') {
+    return 0;
+  }
+
+  trace_file = fopen(path, "wbe");
+  if (trace_file == NULL) {
+    int ret = errno;
+    fprintf(stderr, "could not open trace '%s': %s\n", path, strerror(ret));
+    return ret;
+  }
+  if (fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_SIZE, trace_file) !=
+      TRACE_MAGIC_SIZE) {
+    int ret = errno;
+    trace_stop();
+    return ret;
+  }
+  return 0;
+}
+
+void trace_stop(void) {
+  if (trace_file != NULL) {
+    fclose(trace_file);
+    trace_file = NULL;
+  }
+}
+
+void trace_write(trace_kind_t kind, uint8_t aux, uint32_t value,
+                 const void *data, size_t len) {
+  if (trace_file == NULL) {
+    return;
+  }
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  trace_header_t h = {
+      .kind = (uint8_t)kind,
+      .aux = aux,
+      .len = len > UINT16_MAX ? UINT16_MAX : (uint16_t)len,
+      .value = value,
+      .ns = (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec,
+  };
+  if (fwrite(&h, sizeof(h), 1, trace_file) != 1 ||
+      fwrite(data, 1, h.len, trace_file) != h.len) {
+    fprintf(stderr, "could not write trace, stopping it: %s\n",
+            strerror(errno));
+    trace_stop();
+    return;
+  }
+  if (kind == TRACE_MESSAGE) {
+    fflush(trace_file);
+  }
+}
+
+// read all of `path` into a malloc'ed buffer. returns 0 or errno.
+static int read_file(const char *path, char **buf, size_t *size) {
+  FILE *f = fopen(path, "rbe");
+  if (f == NULL) {
+    return errno;
+  }
+
+  size_t cap = 4096, len = 0;
+  char *p = malloc(cap);
+  int ret = 0;
+  while (p != NULL) {
+    len += fread(p + len, 1, cap - len, f);
+    if (len < cap) {
+      ret = ferror(f) ? EIO : 0;
+      break;
+    }
+    char *grown = realloc(p, cap * 2);
+    if (grown == NULL) {
+      free(p);
+    }
+    p = grown;
+    cap *= 2;
+  }
+  fclose(f);
+
+  if (p == NULL) {
+    return ENOMEM;
+  }
+  if (ret != 0) {
+    free(p);
+    return ret;
+  }
+  *buf = p;
+  *size = len;
+  return 0;
+}
+
+// count the records in a trace body, or return -1 if one is cut off
+static long count_records(const char *p, const char *end) {
+  long n = 0;
+  while (p < end) {
+    trace_header_t h;
+    if ((size_t)(end - p) < sizeof(h)) {
+      return -1;
+    }
+    memcpy(&h, p, sizeof(h));
+    p += sizeof(h);
+    if ((size_t)(end - p) < h.len) {
+      return -1;
+    }
+    p += h.len;
+    n++;
+  }
+  return n;
+}
+
+int trace_load(const char *path, trace_record_t **records, size_t *count) {
+  char *file = NULL;
+  size_t size = 0;
+  int ret = read_file(path, &file, &size);
+  if (ret != 0) {
+    return ret;
+  }
+
+  long n = -1;
+  if (size >= TRACE_MAGIC_SIZE &&
+      memcmp(file, TRACE_MAGIC, TRACE_MAGIC_SIZE) == 0) {
+    n = count_records(file + TRACE_MAGIC_SIZE, file + size);
+  }
+  if (n < 0) {
+    free(file);
+    return EINVAL;
+  }
+
+  // the records, then the trace they point into, in one block
+  size_t index_size = (size_t)n * sizeof(trace_record_t);
+  trace_record_t *r = malloc(index_size + size);
+  if (r == NULL) {
+    free(file);
+    return ENOMEM;
+  }
+  char *p = (char *)r + index_size;
+  memcpy(p, file, size);
+  free(file);
+
+  p += TRACE_MAGIC_SIZE;
+  for (long i = 0; i < n; i++) {
+    memcpy(&r[i].h, p, sizeof(r[i].h));
+    r[i].data = p + sizeof(r[i].h);
+    p += sizeof(r[i].h) + r[i].h.len;
+  }
+  *records = r;
+  *count = (size_t)n;
+  return 0;
+}
+
+void trace_free(trace_record_t *records) { free(records); }
@@ -0,0 +1,76 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_TRACE_H
+#define OMARCHY_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// a path to record a trace of the watcher session to, see serve_replay
+#define TRACE_ENV "OMARCHY_FIREFOX_THEME_TRACE"
+
+// A trace is TRACE_MAGIC followed by records, each a trace_header_t in host
+// byte order and then `len` bytes of data. It is meant to be replayed on the
+// machine that recorded it.
+#define TRACE_MAGIC "OFTRACE1"
+#define TRACE_MAGIC_SIZE 8
+
+typedef enum {
+  // before each batch of inotify events. aux: the TRACE_ROLE_* bits of the
+  // watches armed while it is parsed.
+  TRACE_WATCHES = 1,
+  // one inotify event. aux: the TRACE_ROLE_* of its watch, value: its mask,
+  // data: its name without the NUL.
+  TRACE_EVENT = 2,
+  // chromium.theme read for a message. aux: 1 while `current` is missing,
+  // value: errno, data: the "r,g,b" read when value is 0.
+  TRACE_READ = 3,
+  // a message sent to clients. value: the frame size, data: its hash_bytes.
+  TRACE_MESSAGE = 4,
+} trace_kind_t;
+
+// what an inotify watch descriptor was watching, since the descriptors
+// themselves mean nothing once the host has exited
+#define TRACE_ROLE_OTHER 0   // a watch already dropped
+#define TRACE_ROLE_CURRENT 1 // `current`
+#define TRACE_ROLE_THEME 2   // the directory `current/theme` resolves to
+#define TRACE_ROLE_WAIT 3    // the ancestor waited on while `current` is gone
+
+typedef struct {
+  uint8_t kind; // trace_kind_t
+  uint8_t aux;
+  uint16_t len; // bytes of data after the header
+  uint32_t value;
+  uint64_t ns; // CLOCK_MONOTONIC
+} trace_header_t;
+
+typedef struct {
+  trace_header_t h;
+  const char *data; // h.len bytes, not NUL terminated
+} trace_record_t;
+
+// start recording to the file TRACE_ENV names, if it is set. returns 0 or
+// errno.
+int trace_start(void);
+
+// flush and close the trace, if one is being recorded
+void trace_stop(void);
+
+// append a record stamped with the current time; does nothing unless a trace
+// is being recorded. data is cut off at UINT16_MAX bytes.
+void trace_write(trace_kind_t kind, uint8_t aux, uint32_t value,
+                 const void *data, size_t len);
+
+// load the trace at `path`. on success *records holds *count records that
+// point into one allocation, released with trace_free. returns 0, errno, or
+// EINVAL if the file is not a trace.
+int trace_load(const char *path, trace_record_t **records, size_t *count);
+
+void trace_free(trace_record_t *records);
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "watcher.h"
+
+#include <errno.h>
+#include <pwd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/vfs.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "io.h"
+#include "watcher_backend.h"
+
+#define CHROMIUM_THEME_MAX 12 // 11 chars + NUL for "255,255,255"
+#define STRING_MAX WATCH_PATH_MAX
+#define CURRENT_PATH_FMT "%s/.config/omarchy/current"
+#define CHROMIUM_THEME_PATH_FMT "%s/theme/chromium.theme"
+#define THEME_PATH_FMT "%s/theme"
+
+static watcher_stats_t stats;
+
+static char current_path[STRING_MAX];
+static char theme_path[STRING_MAX];
+static char chromium_theme_path[STRING_MAX];
+static char chromium_theme[CHROMIUM_THEME_MAX];
+
+static const watch_target_t target = {
+    .current_path = current_path,
+    .theme_path = theme_path,
+    .chromium_theme_path = chromium_theme_path,
+    .stats = &stats,
+};
+static const watcher_backend_t *backend = &inotify_watcher;
+
+// get user home directory (intended for linux)
+static int get_home(char *home) {
+  char *h = getenv("HOME");
+  if (h != NULL) {
+    return snprintf_werr(home, STRING_MAX, "%s", h);
+  }
+
+  struct passwd *pw = getpwuid(getuid());
+  if (pw == NULL)
+    return errno;
+
+  return snprintf_werr(home, STRING_MAX, "%s", pw->pw_dir);
+}
+
+// current_path = `~/.config/omarchy/current`
+static int get_current_path(char *current_path) {
+  char home[STRING_MAX];
+  int res = get_home(home);
+  if (res != 0) {
+    return res;
+  }
+
+  return snprintf_werr(current_path, STRING_MAX, CURRENT_PATH_FMT, home);
+}
+
+// chromium_theme_path = `~/.config/omarchy/current/theme/chromium.theme`
+static int get_chromium_theme_path(char *chromium_theme_path,
+                                   const char *current_path) {
+  return snprintf_werr(chromium_theme_path, STRING_MAX, CHROMIUM_THEME_PATH_FMT,
+                       current_path);
+}
+
+// read chromium.theme to string. expect 0..255,0..255,0..255
+static int get_chromium_theme(char *chromium_theme,
+                              const char *chromium_theme_path) {
+  char line[STRING_MAX];
+  int ret = io_read_file(chromium_theme_path, line, sizeof(line));
+  if (ret != 0) {
+    return ret;
+  }
+  // an empty file (e.g. caught mid-rewrite) reads as nothing at all
+  if (line[0] == '\0') {
+    return ENODATA;
+  }
+  line[strcspn(line, "\n")] = '\0';
+
+  int j = 0;
+  for (int i = 0; i < STRING_MAX; i++) {
+    char c = line[i];
+    if (c == '\0') {
+      break;
+    }
+    if ((c >= '0' && c <= '9') || c == ',') {
+      if (j >= CHROMIUM_THEME_MAX - 1) {
+        break;
+      }
+      chromium_theme[j++] = c;
+    }
+  }
+  chromium_theme[j] = '\0';
+
+  return 0;
+}
+
+// statfs f_type of filesystems where a change made on another machine, or
+// by the server behind a FUSE mount such as sshfs, never raises an inotify
+// event here
+static const long REMOTE_FS_TYPES[] = {
+    0x6969,              // NFS
+    0x517b,              // SMB
+    0xff534d42,          // CIFS
+    0xfe534d42,          // SMB2
+    0x65735546,          // FUSE
+    0x01021997,          // 9P
+    0x00c36400,          // Ceph
+    0x6b414653,          // AFS
+    0x73757245,          // Coda
+};
+
+// whether `path`, or its nearest existing ancestor if it is missing, is on a
+// filesystem listed in REMOTE_FS_TYPES
+static int on_remote_fs(const char *path) {
+  char dir[STRING_MAX];
+  if (snprintf_werr(dir, sizeof(dir), "%s", path) != 0) {
+    return 0;
+  }
+
+  struct statfs fs;
+  while (statfs(dir, &fs) == -1) {
+    char *slash = strrchr(dir, '/');
+    if ((errno != ENOENT && errno != ENOTDIR) || slash == NULL ||
+        slash == dir) {
+      return 0;
+    }
+    *slash = '\0';
+  }
+
+  for (size_t i = 0; i < sizeof(REMOTE_FS_TYPES) / sizeof(REMOTE_FS_TYPES[0]);
+       i++) {
+    if ((long)fs.f_type == REMOTE_FS_TYPES[i]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// the backend WATCHER_ENV asks for, or NULL to choose by filesystem
+static const watcher_backend_t *requested_backend(void) {
+  const char *env = getenv(WATCHER_ENV);
+  if (env == NULL || *env == '\0' || strcmp(env, "auto") == 0) {
+    return NULL;
+  }
+  if (strcmp(env, inotify_watcher.name) == 0) {
+    return &inotify_watcher;
+  }
+  if (strcmp(env, poll_watcher.name) == 0) {
+    return &poll_watcher;
+  }
+  fprintf(stderr, "ignoring %s='%s', expected inotify, poll or auto\n",
+          WATCHER_ENV, env);
+  return NULL;
+}
+
+int watcher_open(const char **what) {
+  int ret = get_current_path(current_path);
+  if (ret == 0) {
+    ret = snprintf_werr(theme_path, STRING_MAX, THEME_PATH_FMT, current_path);
+  }
+  if (ret == 0) {
+    ret = get_chromium_theme_path(chromium_theme_path, current_path);
+  }
+  if (ret != 0) {
+    *what =
+        "could not get path '~/.config/omarchy/current/theme/chromium.theme'";
+    return ret;
+  }
+
+  backend = requested_backend();
+  if (backend != NULL) {
+    return backend->open(&target, what);
+  }
+
+  // the theme directories may live on another filesystem than `current`
+  if (on_remote_fs(current_path) || on_remote_fs(chromium_theme_path)) {
+    backend = &poll_watcher;
+    return backend->open(&target, what);
+  }
+
+  backend = &inotify_watcher;
+  ret = backend->open(&target, what);
+  if (ret == EMFILE || ret == ENFILE || ret == ENOSPC || ret == ENOSYS) {
+    // out of inotify instances or watches: max_user_instances and
+    // max_user_watches are shared by every program of the user
+    fprintf(stderr, "%s: %s, polling instead\n", *what, strerror(ret));
+    backend = &poll_watcher;
+    ret = backend->open(&target, what);
+  }
+  return ret;
+}
+
+void watcher_close(void) { backend->close(); }
+
+int watcher_fd(void) { return backend->fd(); }
+
+int watcher_read(void) { return backend->read(); }
+
+const char *watcher_backend(void) { return backend->name; }
+
+// build the message for what was read: `theme`, or the error `err`, or that
+// `current` is missing
+static int format_read(frame_t *frame, int waiting, int err,
+                       const char *theme) {
+  if (waiting) {
+    return format_frame(frame, NULL, "waiting for '~/.config/omarchy/current'",
+                        ENOENT);
+  }
+  if (err != 0) {
+    return format_frame(frame, NULL, "could not read chromium.theme to string",
+                        err);
+  }
+  return format_frame(frame, theme, NULL, 0);
+}
+
+static int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// get_chromium_theme, counted in stats
+static int read_chromium_theme(void) {
+  int64_t start = now_ns();
+  int ret = get_chromium_theme(chromium_theme, chromium_theme_path);
+  stats.read_ns += (uint64_t)(now_ns() - start);
+  stats.reads++;
+  if (ret != 0) {
+    stats.read_errors++;
+  }
+  return ret;
+}
+
+int watcher_format(frame_t *frame) {
+  int waiting = backend->waiting();
+  int ret = waiting ? 0 : read_chromium_theme();
+  size_t len = waiting || ret != 0 ? 0 : strlen(chromium_theme);
+  trace_write(TRACE_READ, (uint8_t)waiting, (uint32_t)ret, chromium_theme,
+              len);
+  return format_read(frame, waiting, ret, chromium_theme);
+}
+
+int watcher_replay_events(uint8_t armed, const trace_record_t *events,
+                          size_t count) {
+  backend = &inotify_watcher;
+  return inotify_replay(&target, armed, events, count);
+}
+
+int watcher_replay_format(frame_t *frame, const trace_record_t *read) {
+  char theme[CHROMIUM_THEME_MAX];
+  size_t len = read->h.len < sizeof(theme) ? read->h.len : sizeof(theme) - 1;
+  memcpy(theme, read->data, len);
+  theme[len] = '\0';
+  return format_read(frame, read->h.aux, (int)read->h.value, theme);
+}
+
+const watcher_stats_t *watcher_stats(void) { return &stats; }
@@ -0,0 +1,79 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_WATCHER_H
+#define OMARCHY_WATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "message.h"
+#include "trace.h"
+
+// "inotify" or "poll" picks the backend. "auto", the default, polls where
+// inotify cannot see every change (NFS, SMB, FUSE mounts such as sshfs, and
+// the like) or has run out of instances or watches, and uses inotify
+// everywhere else.
+#define WATCHER_ENV "OMARCHY_FIREFOX_THEME_WATCH"
+
+// the inotify event bits counted one by one in watcher_stats_t.by_mask
+#define WATCHER_MASKS 7
+
+typedef struct {
+  uint32_t mask;
+  const char *name; // e.g. "IN_MOVED_TO"
+} watcher_mask_t;
+
+extern const watcher_mask_t watcher_masks[WATCHER_MASKS];
+
+typedef struct {
+  uint64_t events;    // inotify events read
+  uint64_t overflows; // IN_Q_OVERFLOW, each followed by a full resync
+  uint64_t polls;     // statx polls made by the polling backend
+  uint64_t by_mask[WATCHER_MASKS]; // events with each watcher_masks bit set
+  uint64_t reads;                  // chromium.theme reads
+  uint64_t read_errors;            // reads that failed
+  uint64_t read_ns;                // time spent in those reads
+} watcher_stats_t;
+
+// pick a backend and start watching `~/.config/omarchy/current`. a missing
+// directory is waited for, not an error. returns 0, or errno with *what set
+// to a description of the step that failed.
+int watcher_open(const char **what);
+
+void watcher_close(void);
+
+// readable whenever watcher_read has events to consume or a poll is due
+int watcher_fd(void);
+
+// read one batch of events, or poll once, and re-arm what went stale.
+// returns the number of changes that may have touched chromium.theme, or -1
+// with errno set.
+int watcher_read(void);
+
+// build the message for the current chromium.theme, or for why it cannot be
+// read yet. returns 0 or errno.
+int watcher_format(frame_t *frame);
+
+// run one recorded batch of TRACE_EVENT records through the inotify
+// backend, as watcher_read would have, with the watches in `armed`
+// (TRACE_ROLE_* bits) in place. needs no watcher_open and touches no
+// filesystem. returns the number of changes that may have touched
+// chromium.theme.
+int watcher_replay_events(uint8_t armed, const trace_record_t *events,
+                          size_t count);
+
+// build the message watcher_format built when it recorded the TRACE_READ
+// record `read`. returns 0 or errno.
+int watcher_replay_format(frame_t *frame, const trace_record_t *read);
+
+// "inotify" or "poll", once watcher_open has picked one
+const char *watcher_backend(void);
+
+const watcher_stats_t *watcher_stats(void);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#ifndef OMARCHY_WATCHER_BACKEND_H
+#define OMARCHY_WATCHER_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace.h"
+#include "watcher.h"
+
+// capacity of every path a backend is handed
+#define WATCH_PATH_MAX 256
+
+// what a backend watches, filled in by watcher_open
+typedef struct {
+  const char *current_path;        // `~/.config/omarchy/current`
+  const char *theme_path;          // `current/theme`
+  const char *chromium_theme_path; // `current/theme/chromium.theme`
+  watcher_stats_t *stats;
+} watch_target_t;
+
+// one way of noticing chromium.theme change. watcher.c picks a backend and
+// forwards the public watcher_* calls to it.
+typedef struct {
+  const char *name;
+  // start watching `target`, which must outlive the backend. a missing
+  // `current` is waited for, not an error. returns 0, or errno with *what
+  // set to a description of the step that failed.
+  int (*open)(const watch_target_t *target, const char **what);
+  void (*close)(void);
+  // readable whenever read has something to consume
+  int (*fd)(void);
+  // returns the number of changes that may have touched chromium.theme, or
+  // -1 with errno set
+  int (*read)(void);
+  // whether `current` is missing and being waited for
+  int (*waiting)(void);
+} watcher_backend_t;
+
+// inotify on `current`, the directory `theme` resolves to, and the nearest
+// existing ancestor while waiting. see watcher_inotify.c.
+extern const watcher_backend_t inotify_watcher;
+
+// run TRACE_EVENT `events`, one recorded batch, through the inotify
+// backend's event parsing as though the watches in `armed` (TRACE_ROLE_*
+// bits) were in place. touches no filesystem. returns the number of changes
+// that may have touched chromium.theme.
+int inotify_replay(const watch_target_t *target, uint8_t armed,
+                   const trace_record_t *events, size_t count);
+
+// statx polling on a timer that backs off while nothing changes, for
+// filesystems inotify cannot see changes on. see watcher_poll.c.
+extern const watcher_backend_t poll_watcher;
+
+#endif
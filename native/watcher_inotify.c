@@ -0,0 +1,326 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _DEFAULT_SOURCE
+
+#include "watcher_backend.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+#define INOTIFY_BUF_LEN 4096
+#define THEME_DIR "theme"
+#define CHROMIUM_THEME_FILE "chromium.theme"
+// `current`: the `theme` link is renamed over (omarchy) or unlinked and
+// recreated (`ln -sf`); `current` itself may go away
+#define CURRENT_MASK (IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF | IN_MOVE_SELF)
+// the directory `theme` resolves to: chromium.theme is edited in place or
+// replaced by rename
+#define THEME_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+// nearest existing ancestor of a missing `current`: the next path component
+// appears, or the ancestor itself goes away
+#define WAIT_MASK                                                              \
+  (IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+const watcher_mask_t watcher_masks[WATCHER_MASKS] = {
+    {IN_CLOSE_WRITE, "IN_CLOSE_WRITE"}, {IN_MOVED_TO, "IN_MOVED_TO"},
+    {IN_CREATE, "IN_CREATE"},           {IN_DELETE_SELF, "IN_DELETE_SELF"},
+    {IN_MOVE_SELF, "IN_MOVE_SELF"},     {IN_IGNORED, "IN_IGNORED"},
+    {IN_Q_OVERFLOW, "IN_Q_OVERFLOW"},
+};
+
+static const watch_target_t *target;
+
+static int notify_fd = -1;
+// watch descriptors for `current` and for the directory `current/theme`
+// resolves to, -1 while missing. wait_wd watches the nearest existing ancestor
+// while `current` is missing.
+static int current_wd = -1;
+static int theme_wd = -1;
+static int wait_wd = -1;
+
+// watch the directory `theme_path` currently resolves to, replacing the watch
+// on the previous target. returns 0, or errno with no target watched.
+static int arm_theme_watch(void) {
+  int wd = inotify_add_watch(notify_fd, target->theme_path, THEME_MASK);
+  int err = wd == -1 ? errno : 0;
+
+  // the same directory yields the same descriptor, which must be kept
+  if (theme_wd >= 0 && theme_wd != wd) {
+    inotify_rm_watch(notify_fd, theme_wd);
+  }
+  theme_wd = wd;
+  return err;
+}
+
+// drop the watch in *wd, if any
+static void drop_watch(int *wd) {
+  if (*wd >= 0) {
+    inotify_rm_watch(notify_fd, *wd);
+    *wd = -1;
+  }
+}
+
+// watch the nearest existing ancestor directory of `path`. returns 0, or
+// errno if no ancestor could be watched.
+static int arm_wait_watch(const char *path) {
+  char dir[WATCH_PATH_MAX];
+  int ret = snprintf_werr(dir, sizeof(dir), "%s", path);
+  if (ret != 0) {
+    return ret;
+  }
+
+  while (1) {
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+      return ENOENT;
+    }
+    slash[slash == dir ? 1 : 0] = '\0';
+
+    int wd = inotify_add_watch(notify_fd, dir, WAIT_MASK);
+    if (wd >= 0) {
+      if (wait_wd != wd) {
+        drop_watch(&wait_wd);
+      }
+      wait_wd = wd;
+      return 0;
+    }
+    if ((errno != ENOENT && errno != ENOTDIR) || slash == dir) {
+      return errno;
+    }
+  }
+}
+
+// arm the watches for the current state of the tree. while `current` is
+// missing its nearest existing ancestor is watched instead, and each path
+// component that appears moves that watch one level down. returns 0 once
+// `current` is watched, ENOENT while waiting, or another errno on failure.
+static int arm_watches(void) {
+  while (current_wd < 0) {
+    current_wd =
+        inotify_add_watch(notify_fd, target->current_path, CURRENT_MASK);
+    if (current_wd >= 0) {
+      drop_watch(&wait_wd);
+      break;
+    }
+    if (errno != ENOENT && errno != ENOTDIR) {
+      return errno;
+    }
+
+    // a component created before the ancestor watch was in place sends no
+    // event, so walk again until the same ancestor comes back
+    drop_watch(&theme_wd);
+    int prev = wait_wd;
+    int ret = arm_wait_watch(target->current_path);
+    if (ret != 0) {
+      return ret;
+    }
+    if (wait_wd == prev) {
+      return ENOENT;
+    }
+  }
+
+  // a missing target is fine here, the link's next IN_CREATE or IN_MOVED_TO
+  // arms it again
+  arm_theme_watch();
+  return 0;
+}
+
+// the TRACE_ROLE_* of what watch descriptor `wd` watches
+static uint8_t watch_role(int wd) {
+  if (wd < 0) {
+    return TRACE_ROLE_OTHER;
+  }
+  if (wd == current_wd) {
+    return TRACE_ROLE_CURRENT;
+  }
+  if (wd == wait_wd) {
+    return TRACE_ROLE_WAIT;
+  }
+  return wd == theme_wd ? TRACE_ROLE_THEME : TRACE_ROLE_OTHER;
+}
+
+// the TRACE_ROLE_* bits of the armed watches
+static uint8_t armed_roles(void) {
+  return (uint8_t)((current_wd >= 0 ? 1u << TRACE_ROLE_CURRENT : 0) |
+                   (theme_wd >= 0 ? 1u << TRACE_ROLE_THEME : 0) |
+                   (wait_wd >= 0 ? 1u << TRACE_ROLE_WAIT : 0));
+}
+
+// parse one batch of events. returns the number of events that change
+// chromium.theme and sets *rearm when the `theme` link may point somewhere
+// else, when a path being waited for may have appeared, or when events were
+// lost.
+static int parse_theme_events(const char *buf, ssize_t n, int *rearm) {
+  int matched = 0;
+  for (ssize_t off = 0; off < n;) {
+    const struct inotify_event *ev =
+        (const struct inotify_event *)(buf + off);
+    size_t ev_size = sizeof(struct inotify_event) + ev->len;
+    if (off + ev_size > (size_t)n) {
+      break;
+    }
+
+    target->stats->events++;
+    for (int i = 0; i < WATCHER_MASKS; i++) {
+      if (ev->mask & watcher_masks[i].mask) {
+        target->stats->by_mask[i]++;
+      }
+    }
+    trace_write(TRACE_EVENT, watch_role(ev->wd), ev->mask, ev->name,
+                strnlen(ev->name, ev->len));
+    if (ev->mask & IN_Q_OVERFLOW) {
+      // anything may have changed, resync from scratch
+      target->stats->overflows++;
+      *rearm = 1;
+      matched++;
+    } else if (ev->wd == current_wd) {
+      if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        // `current` is gone, wait for it to come back
+        drop_watch(&current_wd);
+        *rearm = 1;
+        matched++;
+      } else if ((ev->mask & CURRENT_MASK) && ev->len > 0 &&
+                 strcmp(ev->name, THEME_DIR) == 0) {
+        *rearm = 1;
+        matched++;
+      }
+    } else if (ev->wd == wait_wd) {
+      // a path component appeared or the ancestor went away
+      if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        drop_watch(&wait_wd);
+      }
+      *rearm = 1;
+      matched++;
+    } else if (ev->wd == theme_wd) {
+      if (ev->mask & IN_IGNORED) {
+        // the target directory was removed
+        theme_wd = -1;
+        *rearm = 1;
+      } else if ((ev->mask & THEME_MASK) && ev->len > 0 &&
+                 strcmp(ev->name, CHROMIUM_THEME_FILE) == 0) {
+        matched++;
+      }
+    }
+
+    off += ev_size;
+  }
+  return matched;
+}
+
+static void inotify_close(void) {
+  if (notify_fd >= 0) {
+    close(notify_fd);
+    notify_fd = -1;
+  }
+  current_wd = theme_wd = wait_wd = -1;
+}
+
+static int inotify_open(const watch_target_t *t, const char **what) {
+  target = t;
+  notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (notify_fd == -1) {
+    *what = "could not init inotify";
+    return errno;
+  }
+
+  // a missing `current` is not an error: the host waits for omarchy to be
+  // set up instead of exiting and being respawned by the extension
+  int ret = arm_watches();
+  if (ret != 0 && ret != ENOENT) {
+    *what = "could not watch directory '~/.config/omarchy/current'";
+    inotify_close();
+    return ret;
+  }
+  return 0;
+}
+
+static int inotify_fd(void) { return notify_fd; }
+
+static int inotify_read(void) {
+  // aligned for struct inotify_event
+  static char buf[INOTIFY_BUF_LEN]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+
+  ssize_t n;
+  do {
+    n = read(notify_fd, buf, sizeof(buf));
+  } while (n == -1 && errno == EINTR);
+  if (n == -1) {
+    return errno == EAGAIN ? 0 : -1;
+  }
+
+  trace_write(TRACE_WATCHES, armed_roles(), 0, NULL, 0);
+  int rearm = 0;
+  int matched = parse_theme_events(buf, n, &rearm);
+  if (rearm) {
+    arm_watches();
+  }
+  return matched;
+}
+
+int inotify_replay(const watch_target_t *t, uint8_t armed,
+                   const trace_record_t *events, size_t count) {
+  static char buf[INOTIFY_BUF_LEN]
+      __attribute__((aligned(__alignof__(struct inotify_event))));
+
+  // each role stands in for the descriptor of its watch, and
+  // TRACE_ROLE_OTHER for one already dropped. notify_fd stays -1,
+  // so dropping one touches nothing real, and the next TRACE_WATCHES record
+  // tells what was armed again.
+  target = t;
+  current_wd = armed & (1u << TRACE_ROLE_CURRENT) ? TRACE_ROLE_CURRENT : -1;
+  theme_wd = armed & (1u << TRACE_ROLE_THEME) ? TRACE_ROLE_THEME : -1;
+  wait_wd = armed & (1u << TRACE_ROLE_WAIT) ? TRACE_ROLE_WAIT : -1;
+
+  int matched = 0;
+  size_t n = 0;
+  for (size_t i = 0; i <= count; i++) {
+    // names padded with NULs to keep the next event aligned, as the kernel
+    // does
+    size_t name_len = 0;
+    if (i < count && events[i].h.len > 0) {
+      name_len = (events[i].h.len + sizeof(struct inotify_event)) &
+                 ~(sizeof(struct inotify_event) - 1);
+    }
+    size_t ev_size = sizeof(struct inotify_event) + name_len;
+    if (i == count || n + ev_size > sizeof(buf)) {
+      int rearm = 0;
+      matched += parse_theme_events(buf, (ssize_t)n, &rearm);
+      n = 0;
+    }
+    if (i == count || ev_size > sizeof(buf)) {
+      continue;
+    }
+
+    struct inotify_event *ev = (struct inotify_event *)(buf + n);
+    *ev = (struct inotify_event){
+        .wd = events[i].h.aux,
+        .mask = events[i].h.value,
+        .len = (uint32_t)name_len,
+    };
+    memset(ev->name, 0, name_len);
+    memcpy(ev->name, events[i].data, events[i].h.len);
+    n += ev_size;
+  }
+  return matched;
+}
+
+static int inotify_waiting(void) { return current_wd < 0; }
+
+const watcher_backend_t inotify_watcher = {
+    .name = "inotify",
+    .open = inotify_open,
+    .close = inotify_close,
+    .fd = inotify_fd,
+    .read = inotify_read,
+    .waiting = inotify_waiting,
+};
@@ -0,0 +1,145 @@
+/**
+ * @license MIT
+ * Copyright 2025 VannRR <https://github.com/vannrr>
+ *
+ * see the LICENSE file for details
+ */
+
+#define _GNU_SOURCE
+
+#include "watcher_backend.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// omarchy writes a theme as several files in quick succession, so right after
+// a change the next poll comes soon; every poll that sees nothing new doubles
+// the wait, up to POLL_MAX_MS
+#define POLL_MIN_MS 100
+#define POLL_MAX_MS 2000
+
+// what one poll saw. zeroed before it is filled in, so two can be compared
+// with memcmp.
+typedef struct {
+  int current_err; // errno from statx of `current`, or 0
+  int theme_err;   // errno from statx of chromium.theme, or 0
+  uint32_t dev_major;
+  uint32_t dev_minor;
+  uint64_t ino;
+  uint64_t size;
+  struct statx_timestamp mtime;
+  struct statx_timestamp ctime;
+} snapshot_t;
+
+static const watch_target_t *target;
+
+static int timer_fd = -1;
+static int interval_ms = POLL_MIN_MS;
+static snapshot_t last;
+
+static void take_snapshot(snapshot_t *s) {
+  memset(s, 0, sizeof(*s));
+
+  // AT_STATX_FORCE_SYNC: NFS and FUSE would otherwise answer from attributes
+  // cached for seconds. a local filesystem ignores it.
+  struct statx stx;
+  if (statx(AT_FDCWD, target->current_path, AT_STATX_FORCE_SYNC, STATX_TYPE,
+            &stx) == -1) {
+    s->current_err = errno;
+  }
+
+  // through the `theme` link, so pointing it at another theme changes the
+  // device and inode even when the file contents look alike
+  if (statx(AT_FDCWD, target->chromium_theme_path, AT_STATX_FORCE_SYNC,
+            STATX_INO | STATX_SIZE | STATX_MTIME | STATX_CTIME, &stx) == -1) {
+    s->theme_err = errno;
+    return;
+  }
+  s->dev_major = stx.stx_dev_major;
+  s->dev_minor = stx.stx_dev_minor;
+  s->ino = stx.stx_ino;
+  s->size = stx.stx_size;
+  s->mtime = stx.stx_mtime;
+  s->ctime = stx.stx_ctime;
+}
+
+// fire the timer once, interval_ms from now. returns 0 or errno.
+static int arm_timer(void) {
+  struct itimerspec its = {
+      .it_value = {.tv_sec = interval_ms / 1000,
+                   .tv_nsec = (long)(interval_ms % 1000) * 1000000}};
+  return timerfd_settime(timer_fd, 0, &its, NULL) == -1 ? errno : 0;
+}
+
+static void poll_close(void) {
+  if (timer_fd >= 0) {
+    close(timer_fd);
+    timer_fd = -1;
+  }
+}
+
+static int poll_open(const watch_target_t *t, const char **what) {
+  target = t;
+  timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timer_fd == -1) {
+    *what = "could not create poll timer";
+    return errno;
+  }
+
+  take_snapshot(&last);
+  interval_ms = POLL_MIN_MS;
+  int ret = arm_timer();
+  if (ret != 0) {
+    *what = "could not arm poll timer";
+    poll_close();
+  }
+  return ret;
+}
+
+static int poll_fd(void) { return timer_fd; }
+
+static int poll_read(void) {
+  uint64_t expirations;
+  ssize_t n;
+  do {
+    n = read(timer_fd, &expirations, sizeof(expirations));
+  } while (n == -1 && errno == EINTR);
+  if (n == -1) {
+    return errno == EAGAIN ? 0 : -1;
+  }
+
+  target->stats->polls++;
+  snapshot_t now;
+  take_snapshot(&now);
+
+  int matched = memcmp(&now, &last, sizeof(now)) != 0;
+  if (matched) {
+    last = now;
+    interval_ms = POLL_MIN_MS;
+  } else if (interval_ms < POLL_MAX_MS) {
+    interval_ms = interval_ms * 2 < POLL_MAX_MS ? interval_ms * 2 : POLL_MAX_MS;
+  }
+
+  int ret = arm_timer();
+  if (ret != 0) {
+    errno = ret;
+    return -1;
+  }
+  return matched;
+}
+
+static int poll_waiting(void) { return last.current_err != 0; }
+
+const watcher_backend_t poll_watcher = {
+    .name = "poll",
+    .open = poll_open,
+    .close = poll_close,
+    .fd = poll_fd,
+    .read = poll_read,
+    .waiting = poll_waiting,
+};